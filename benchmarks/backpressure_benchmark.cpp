@@ -0,0 +1,147 @@
+/**
+ * @file backpressure_benchmark.cpp
+ * @brief 有界队列：下游变慢时无界队列与各溢出策略的内存占用和吞吐量
+ *
+ * 一个生产者每约 5us 产生一个携带 4KB 数据的任务，提交到一个 ThreadedDispatchQueue，
+ * 消费者处理每个任务约 20us（下游比上游慢 4 倍）。分别测量：
+ * - 无界队列：生产者不受限制，积压的任务和数据持续增长
+ * - Block：队列已满时生产者在条件变量上等待，吞吐量由消费者决定，积压不超过容量
+ * - DropNewest / DropOldest：生产者不等待，超出容量的任务被丢弃
+ * - tryAsync + 回调：队列已满时不占用线程阻塞，由腾出空间时的回调通知生产者重试
+ * 输出耗时、执行和丢弃的任务数，以及同时存活的数据块峰值（近似队列占用的内存）。
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "dispatcher/ThreadedDispatchQueue.h"
+
+using namespace dispatch;
+
+namespace {
+
+/// 每个任务携带的数据大小
+constexpr size_t kPayloadBytes = 4096;
+
+/// 有界队列的容量
+constexpr size_t kCapacity = 256;
+
+/// 模拟一段计算
+void spin(std::chrono::microseconds duration) {
+  auto until = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < until) {
+  }
+}
+
+/**
+ * @brief 任务携带的数据，统计同时存活的数量
+ */
+struct Payload {
+  static std::atomic<size_t> live;
+  static std::atomic<size_t> peak;
+
+  std::vector<char> bytes = std::vector<char>(kPayloadBytes, 1);
+
+  Payload() {
+    auto now = live.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto previous = peak.load(std::memory_order_relaxed);
+    while (now > previous && !peak.compare_exchange_weak(previous, now, std::memory_order_relaxed)) {
+    }
+  }
+  ~Payload() { live.fetch_sub(1, std::memory_order_relaxed); }
+};
+
+std::atomic<size_t> Payload::live{0};
+std::atomic<size_t> Payload::peak{0};
+
+enum class Mode { Unbounded, Block, DropNewest, DropOldest, TryAsync };
+
+void report(const char* name, Mode mode, size_t items) {
+  auto queue = std::make_shared<ThreadedDispatchQueue>("Consumer", kThreadQoSClassNormal);
+  switch (mode) {
+    case Mode::Unbounded:
+      break;
+    case Mode::Block:
+    case Mode::TryAsync:
+      queue->setCapacity(kCapacity, OverflowPolicy::Block);
+      break;
+    case Mode::DropNewest:
+      queue->setCapacity(kCapacity, OverflowPolicy::DropNewest);
+      break;
+    case Mode::DropOldest:
+      queue->setCapacity(kCapacity, OverflowPolicy::DropOldest);
+      break;
+  }
+  Payload::peak.store(0);
+
+  // tryAsync 被拒绝后生产者等待回调通知
+  std::mutex mutex;
+  std::condition_variable spaceAvailable;
+  bool space = false;
+
+  std::atomic<size_t> executed{0};
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < items; ++i) {
+    spin(std::chrono::microseconds(5));
+    TaskFunction task([payload = std::make_unique<Payload>(), &executed]() {
+      spin(std::chrono::microseconds(20));
+      // 读取数据，确保数据块一直存活到任务执行
+      executed.fetch_add(payload->bytes.front() == 1 ? 1 : 0, std::memory_order_relaxed);
+    });
+    if (mode != Mode::TryAsync) {
+      queue->async(std::move(task));
+      continue;
+    }
+    for (;;) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        space = false;
+      }
+      auto accepted = queue->tryAsync(std::move(task), [&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        space = true;
+        spaceAvailable.notify_one();
+      });
+      if (accepted) {
+        break;
+      }
+      std::unique_lock<std::mutex> lock(mutex);
+      spaceAvailable.wait(lock, [&space]() { return space; });
+    }
+  }
+  queue->sync([]() {});
+  auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  auto stats = queue->overflowStats();
+  auto peak = Payload::peak.load();
+  std::cout << std::setw(12) << name << std::fixed << std::setprecision(1) << std::setw(12) << elapsed
+            << std::setw(12) << executed.load() << std::setw(12) << stats.dropped << std::setw(12)
+            << stats.blocked + stats.rejected << std::setw(12) << peak << std::setw(12)
+            << static_cast<double>(peak * kPayloadBytes) / (1024.0 * 1024.0) << "\n";
+  queue->fullTeardown();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t items = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+
+  std::cout << "=== Backpressure benchmark (" << items << " items of " << kPayloadBytes
+            << " bytes, consumer 4x slower, capacity " << kCapacity << ") ===\n";
+  std::cout << std::setw(12) << "mode" << std::setw(12) << "ms" << std::setw(12) << "executed" << std::setw(12)
+            << "dropped" << std::setw(12) << "waits" << std::setw(12) << "peak items" << std::setw(12) << "peak MB"
+            << "\n";
+  report("unbounded", Mode::Unbounded, items);
+  report("block", Mode::Block, items);
+  report("drop-newest", Mode::DropNewest, items);
+  report("drop-oldest", Mode::DropOldest, items);
+  report("tryAsync", Mode::TryAsync, items);
+  return 0;
+}
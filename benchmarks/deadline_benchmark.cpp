@@ -0,0 +1,84 @@
+/**
+ * @file deadline_benchmark.cpp
+ * @brief 截止时间调度：先入先出与 EDF 下错过截止时间的比例
+ *
+ * 线程池持续收到三类任务（每个约 200us）：截止时间 2ms 的紧急请求、截止时间 50ms 的普通请求，
+ * 以及没有截止时间的后台任务；每隔一段时间出现一次突发，队列短暂积压。分别测量：
+ * - SchedulingPolicy::Priority：所有任务按提交顺序执行
+ * - SchedulingPolicy::EarliestDeadlineFirst：带截止时间的任务按截止时间先执行
+ * - EDF 加 DeadlineMissPolicy::Drop：已经超时的任务不再执行，把线程留给还来得及的任务
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "dispatcher/DispatchGroup.h"
+#include "dispatcher/ThreadPoolDispatchQueue.h"
+
+using namespace dispatch;
+
+namespace {
+
+/// 模拟一个约 200us 的任务
+void work() {
+  auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(200);
+  while (std::chrono::steady_clock::now() < until) {
+  }
+}
+
+void report(const char* name, SchedulingPolicy scheduling, DeadlineMissPolicy missPolicy, size_t threads,
+            size_t rounds) {
+  auto pool = ThreadPoolDispatchQueue::create("Deadline", threads);
+  pool->setSchedulingPolicy(scheduling);
+  pool->setDeadlineMissPolicy(missPolicy);
+
+  DispatchGroup group;
+  std::atomic<size_t> background{0};
+  size_t submitted = 0;
+  for (size_t round = 0; round < rounds; ++round) {
+    // 平时每轮提交的工作约占线程池 60% 的时间，每 20 轮突发一次（15 倍），突发期间紧急请求也无法全部按时完成
+    size_t burst = round % 20 == 0 ? 15 : 1;
+    for (size_t i = 0; i < threads * burst; ++i) {
+      pool->async(group, [&background]() {
+        work();
+        background.fetch_add(1, std::memory_order_relaxed);
+      });
+      pool->asyncWithDeadline(group, work, std::chrono::milliseconds(50));
+      pool->asyncWithDeadline(group, work, std::chrono::milliseconds(2));
+      submitted += 2;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  group.wait();
+  pool->sync([]() {});
+
+  auto stats = pool->deadlineStats();
+  auto missed = stats.missed + stats.dropped;
+  std::cout << std::setw(12) << name << std::setw(12) << submitted << std::setw(12) << stats.completed << std::setw(12)
+            << stats.missed << std::setw(12) << stats.dropped << std::fixed << std::setprecision(1) << std::setw(11)
+            << 100.0 * static_cast<double>(missed) / static_cast<double>(std::max<size_t>(submitted, 1)) << "%"
+            << std::setw(12) << background.load() << "\n";
+  pool->fullTeardown();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500;
+  size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+  std::cout << "=== Deadline scheduling benchmark (" << threads << " threads, " << rounds << " rounds) ===\n";
+  std::cout << std::setw(12) << "policy" << std::setw(12) << "deadline" << std::setw(12) << "completed" << std::setw(12)
+            << "missed" << std::setw(12) << "dropped" << std::setw(12) << "miss rate" << std::setw(12) << "background"
+            << "\n";
+  report("fifo", SchedulingPolicy::Priority, DeadlineMissPolicy::Run, threads, rounds);
+  report("edf", SchedulingPolicy::EarliestDeadlineFirst, DeadlineMissPolicy::Run, threads, rounds);
+  report("edf+drop", SchedulingPolicy::EarliestDeadlineFirst, DeadlineMissPolicy::Drop, threads, rounds);
+  return 0;
+}
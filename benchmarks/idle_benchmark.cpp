@@ -0,0 +1,204 @@
+/**
+ * @file idle_benchmark.cpp
+ * @brief 空闲线程池的唤醒次数与销毁延迟
+ *
+ * 创建 1 到 64 个线程的线程池，执行一个任务后保持空闲一段时间，统计：
+ * - 空闲期间整个进程的上下文切换次数（空闲的工作线程不应被周期性唤醒）
+ * - fullTeardown() 的耗时（空闲的工作线程应被立即唤醒退出）
+ *
+ * 任一指标超出阈值时以非零状态退出，可用于回归检查。
+ * 上下文切换次数通过 getrusage 获取，仅在 POSIX 系统上可用。
+ *
+ * 另外比较 500 个执行过任务后空闲的 ThreadedDispatchQueue 在设置/不设置空闲超时时的
+ * 进程线程数、常驻内存（仅 Linux）以及线程启动/退出次数（仅输出，不参与检查）。
+ *
+ * 最后让一个 1 到 2 个线程、空闲超时极短的弹性线程池反复扩容和退出（突发提交与短暂空闲交替），
+ * 检查任务全部执行、线程数不超过上限，并输出创建与退出的线程数。
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dispatcher/DispatchGroup.h"
+#include "dispatcher/ThreadPoolDispatchQueue.h"
+#include "dispatcher/ThreadedDispatchQueue.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define DISPATCHER_HAS_RUSAGE 1
+#endif
+
+using namespace dispatch;
+
+namespace {
+
+/// 当前进程累计的上下文切换次数（自愿 + 非自愿）
+long contextSwitches() {
+#ifdef DISPATCHER_HAS_RUSAGE
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_nvcsw + usage.ru_nivcsw;
+#else
+  return 0;
+#endif
+}
+
+/// 读取 /proc/self/status 中的数值字段（仅 Linux，其他平台返回 0）
+size_t processStatus(const char* field) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  auto length = std::strlen(field);
+  while (std::getline(status, line)) {
+    if (line.compare(0, length, field) == 0) {
+      return std::strtoul(line.c_str() + length, nullptr, 10);
+    }
+  }
+  return 0;
+}
+
+/// 执行过一个任务（使用一部分线程栈）后空闲的串行队列：比较线程数、常驻内存与线程启动/退出次数
+void reportIdleQueues(std::chrono::milliseconds idleTimeout, std::chrono::milliseconds idle) {
+  constexpr size_t kQueueCount = 500;
+  std::vector<std::shared_ptr<ThreadedDispatchQueue>> queues;
+  for (size_t i = 0; i < kQueueCount; ++i) {
+    auto queue = std::make_shared<ThreadedDispatchQueue>("Session", kThreadQoSClassNormal);
+    queue->setIdleTimeout(idleTimeout);
+    queue->async([]() {
+      // 每页写一次，让任务使用 64KB 线程栈
+      volatile char scratch[64 * 1024];
+      for (size_t i = 0; i < sizeof(scratch); i += 512) {
+        scratch[i] = 1;
+      }
+    });
+    queues.push_back(queue);
+  }
+  for (auto& queue : queues) {
+    queue->sync([]() {});
+  }
+  std::this_thread::sleep_for(idle);
+
+  uint64_t starts = 0;
+  uint64_t retirements = 0;
+  size_t stackBytes = 0;
+  for (auto& queue : queues) {
+    auto stats = queue->threadStats();
+    starts += stats.threadStarts;
+    retirements += stats.threadRetirements;
+    stackBytes += stats.stackBytes;
+  }
+
+  std::cout << std::setw(12) << idleTimeout.count() << std::setw(10) << processStatus("Threads:") << std::setw(14)
+            << processStatus("VmRSS:") << std::setw(16) << stackBytes / 1024 << std::setw(10) << starts
+            << std::setw(10) << retirements << "\n";
+
+  for (auto& queue : queues) {
+    queue->fullTeardown();
+  }
+}
+
+/// 弹性线程池反复扩容与退出：每轮突发提交一批任务，短暂空闲让多出的线程超时退出；
+/// 不等待上一批执行完毕，线程退出与其他线程扩容会并发发生
+bool reportChurn(size_t rounds) {
+  ThreadPoolOptions options;
+  options.minThreads = 1;
+  options.maxThreads = 2;
+  options.idleTimeout = std::chrono::microseconds(1);
+  options.spawnBacklog = 1;
+  options.spawnLatency = std::chrono::steady_clock::duration::zero();
+  auto pool = ThreadPoolDispatchQueue::create("Churn", options);
+
+  DispatchGroup group;
+  std::atomic<size_t> executed{0};
+  size_t submitted = 0;
+  size_t maxThreads = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < rounds; ++round) {
+    auto burst = 1 + round % 8;
+    for (size_t i = 0; i < burst; ++i) {
+      pool->async(group, [&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+    }
+    submitted += burst;
+    maxThreads = std::max(maxThreads, pool->stats().threads);
+    std::this_thread::sleep_for(std::chrono::microseconds(round % 3 == 0 ? 30 : 2));
+  }
+  group.wait();
+  auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  auto stats = pool->stats();
+  pool->fullTeardown();
+
+  bool ok = executed.load() == submitted && maxThreads <= options.maxThreads;
+  std::cout << std::setw(10) << rounds << std::setw(12) << stats.spawned << std::setw(12) << stats.retired
+            << std::setw(14) << maxThreads << std::fixed << std::setprecision(1) << std::setw(12) << elapsed
+            << (ok ? "" : "   FAIL") << "\n";
+  return ok;
+}
+
+/// 空闲期间允许的上下文切换次数（主线程自身的 sleep 以及偶发的调度抢占）
+constexpr long kMaxIdleSwitches = 4;
+
+/// 允许的最大销毁耗时
+constexpr auto kMaxTeardown = std::chrono::milliseconds(100);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  auto idleMillis = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 1500;
+  auto idle = std::chrono::milliseconds(idleMillis);
+  bool failed = false;
+
+#ifndef DISPATCHER_HAS_RUSAGE
+  std::cout << "note: context switch counts are not available on this platform\n";
+#endif
+
+  std::cout << "=== Idle thread pool (" << idleMillis << " ms idle per run) ===\n";
+  std::cout << std::setw(8) << "threads" << std::setw(16) << "idle switches" << std::setw(16) << "teardown ms"
+            << "\n";
+
+  for (size_t threads = 1; threads <= 64; threads *= 2) {
+    auto pool = ThreadPoolDispatchQueue::create("Idle", threads);
+
+    // 让所有工作线程至少运行一次，然后进入空闲状态
+    pool->sync([]() {});
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    auto switchesBefore = contextSwitches();
+    std::this_thread::sleep_for(idle);
+    auto idleSwitches = contextSwitches() - switchesBefore;
+
+    auto start = std::chrono::steady_clock::now();
+    pool->fullTeardown();
+    auto teardown = std::chrono::steady_clock::now() - start;
+    auto teardownMillis = std::chrono::duration<double, std::milli>(teardown).count();
+
+    bool ok = idleSwitches <= kMaxIdleSwitches && teardown <= kMaxTeardown;
+    failed = failed || !ok;
+
+    std::cout << std::setw(8) << threads << std::setw(16) << idleSwitches << std::fixed << std::setprecision(3)
+              << std::setw(16) << teardownMillis << (ok ? "" : "   FAIL") << "\n";
+  }
+
+  std::cout << "\n=== 500 idle ThreadedDispatchQueues after one task each (" << idleMillis << " ms idle) ===\n";
+  std::cout << std::setw(12) << "timeout ms" << std::setw(10) << "threads" << std::setw(14) << "VmRSS KiB"
+            << std::setw(16) << "stack KiB" << std::setw(10) << "starts" << std::setw(10) << "retired"
+            << "\n";
+  reportIdleQueues(std::chrono::milliseconds(0), idle);
+  reportIdleQueues(std::chrono::milliseconds(100), idle);
+
+  std::cout << "\n=== Elastic pool retire/respawn churn (min 1, max 2 threads, 1 us idle timeout) ===\n";
+  std::cout << std::setw(10) << "rounds" << std::setw(12) << "spawned" << std::setw(12) << "retired" << std::setw(14)
+            << "max threads" << std::setw(12) << "ms"
+            << "\n";
+  failed = !reportChurn(20000) || failed;
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file priority_benchmark.cpp
+ * @brief 任务优先级通道：低优先级积压下高优先级任务的延迟
+ *
+ * 同一个线程池中先提交大量低优先级（kThreadQoSClassLow）的短任务形成积压，
+ * 然后每隔 1ms 提交一个探测任务，测量从提交到开始执行的时间：
+ * - 与积压同一优先级的探测任务按先入先出排在积压之后
+ * - 更高优先级的探测任务进入更高的通道，只需等待一个正在执行的任务
+ * 最后验证老化：高优先级通道持续有任务时，低优先级任务仍按比例得到执行。
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dispatcher/DispatchGroup.h"
+#include "dispatcher/ThreadPoolDispatchQueue.h"
+
+using namespace dispatch;
+
+namespace {
+
+const char* priorityName(ThreadQoSClass priority) {
+  switch (priority) {
+    case kThreadQoSClassLowest:
+      return "lowest";
+    case kThreadQoSClassLow:
+      return "low";
+    case kThreadQoSClassNormal:
+      return "normal";
+    case kThreadQoSClassHigh:
+      return "high";
+    case kThreadQoSClassMax:
+      return "max";
+  }
+  return "?";
+}
+
+/// 模拟一个约 10us 的任务
+void work() {
+  auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(10);
+  while (std::chrono::steady_clock::now() < until) {
+  }
+}
+
+void reportLatency(ThreadPoolDispatchQueue& pool, ThreadQoSClass probePriority, size_t backlog, size_t samples) {
+  DispatchGroup group;
+  std::atomic<size_t> backlogDone{0};
+  for (size_t i = 0; i < backlog; ++i) {
+    pool.async(
+        group,
+        [&backlogDone]() {
+          work();
+          backlogDone.fetch_add(1, std::memory_order_relaxed);
+        },
+        kThreadQoSClassLow);
+  }
+
+  std::vector<double> latencies;
+  latencies.reserve(samples);
+  std::mutex mutex;
+  for (size_t i = 0; i < samples; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    auto submitted = std::chrono::steady_clock::now();
+    pool.async(
+        group,
+        [&latencies, &mutex, submitted]() {
+          auto latency =
+              std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - submitted).count();
+          std::lock_guard<std::mutex> lock(mutex);
+          latencies.push_back(latency);
+        },
+        probePriority);
+  }
+  auto backlogAtLastProbe = backlogDone.load();
+  group.wait();
+
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << std::setw(10) << priorityName(probePriority) << std::fixed << std::setprecision(1) << std::setw(12)
+            << latencies[latencies.size() / 2] << std::setw(12) << latencies[latencies.size() * 99 / 100]
+            << std::setw(12) << latencies.back() << std::setw(16) << backlogAtLastProbe << "\n";
+}
+
+void reportAging(ThreadPoolDispatchQueue& pool, size_t highTasks, size_t lowTasks) {
+  // 先占住所有线程，让两个通道都排满后再开始执行
+  std::atomic<bool> release{false};
+  DispatchGroup group;
+  for (size_t i = 0; i < pool.threadCount(); ++i) {
+    pool.async(group, [&release]() {
+      while (!release.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  std::atomic<size_t> highDone{0};
+  std::atomic<size_t> lowDoneAtHalf{0};
+  std::atomic<size_t> lowDone{0};
+  for (size_t i = 0; i < lowTasks; ++i) {
+    pool.async(
+        group, [&lowDone]() { lowDone.fetch_add(1, std::memory_order_relaxed); }, kThreadQoSClassLowest);
+  }
+  for (size_t i = 0; i < highTasks; ++i) {
+    pool.async(
+        group,
+        [&]() {
+          work();
+          if (highDone.fetch_add(1, std::memory_order_relaxed) + 1 == highTasks / 2) {
+            lowDoneAtHalf.store(lowDone.load(std::memory_order_relaxed));
+          }
+        },
+        kThreadQoSClassMax);
+  }
+  release.store(true, std::memory_order_release);
+  group.wait();
+
+  std::cout << "\nAging: " << lowTasks << " lowest-priority tasks queued behind " << highTasks
+            << " max-priority tasks\n";
+  std::cout << "  lowest-priority tasks done when half of the max-priority tasks had run: " << lowDoneAtHalf.load()
+            << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+  samples = std::max<size_t>(samples, 1);
+  size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  // 积压约为探测时长的两倍（每个任务约 10us），探测期间线程池始终饱和
+  size_t backlog = threads * samples * 200;
+
+  auto pool = ThreadPoolDispatchQueue::create("Priority", threads);
+
+  std::cout << "=== Priority lanes benchmark (" << threads << " threads, backlog of " << backlog
+            << " low-priority tasks, " << samples << " probes) ===\n";
+  std::cout << std::setw(10) << "probe" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << std::setw(12)
+            << "max us" << std::setw(16) << "backlog done"
+            << "\n";
+  for (auto priority : {kThreadQoSClassLow, kThreadQoSClassNormal, kThreadQoSClassHigh, kThreadQoSClassMax}) {
+    reportLatency(*pool, priority, backlog, samples);
+  }
+
+  reportAging(*pool, 20000, 2000);
+
+  pool->fullTeardown();
+  return 0;
+}
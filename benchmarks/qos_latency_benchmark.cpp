@@ -0,0 +1,154 @@
+/**
+ * @file qos_latency_benchmark.cpp
+ * @brief CPU 被占满时不同服务质量等级的唤醒延迟
+ *
+ * 一个线程池以给定的等级运行持续自旋的任务，占满所有 CPU（线程数为 CPU 数的两倍）；
+ * 同时一个空闲的 ThreadedDispatchQueue 以另一个等级每隔一段时间收到一个任务，
+ * 测量从提交到开始执行的时间。后台负载的等级越低、探测队列的等级越高，探测任务越快得到 CPU。
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dispatcher/DispatchQueue.h"
+#include "dispatcher/ThreadPoolDispatchQueue.h"
+#include "dispatcher/ThreadQoS.h"
+
+using namespace dispatch;
+
+namespace {
+
+const char* qosName(ThreadQoSClass qosClass) {
+  switch (qosClass) {
+    case kThreadQoSClassLowest:
+      return "lowest";
+    case kThreadQoSClassLow:
+      return "low";
+    case kThreadQoSClassNormal:
+      return "normal";
+    case kThreadQoSClassHigh:
+      return "high";
+    case kThreadQoSClassMax:
+      return "max";
+  }
+  return "?";
+}
+
+/// 在临时线程上检查当前进程是否有权限设置该等级
+bool canApply(ThreadQoSClass qosClass) {
+  bool applied = false;
+  std::thread([&applied, qosClass]() { applied = ThreadQoS::applyToCurrentThread(qosClass); }).join();
+  return applied;
+}
+
+/**
+ * @brief 后台负载：线程池的每个线程循环执行约 1ms 的自旋任务，直到析构
+ */
+class BackgroundLoad {
+ public:
+  BackgroundLoad(ThreadQoSClass qosClass, size_t threads) {
+    ThreadPoolOptions options;
+    options.minThreads = threads;
+    options.maxThreads = threads;
+    options.qosClass = qosClass;
+    pool_ = ThreadPoolDispatchQueue::create("Load", options);
+    for (size_t i = 0; i < threads; ++i) {
+      spin();
+    }
+  }
+
+  ~BackgroundLoad() {
+    running_.store(false);
+    pool_->fullTeardown();
+  }
+
+ private:
+  void spin() {
+    pool_->async([this]() {
+      auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+      while (std::chrono::steady_clock::now() < until) {
+      }
+      if (running_.load(std::memory_order_relaxed)) {
+        spin();
+      }
+    });
+  }
+
+  std::shared_ptr<ThreadPoolDispatchQueue> pool_;
+  std::atomic<bool> running_{true};
+};
+
+void report(const char* loadName, ThreadQoSClass probeClass, size_t samples) {
+  auto probe = DispatchQueue::createThreaded("Probe", probeClass);
+  probe->sync([]() {});
+
+  std::vector<double> latencies;
+  latencies.reserve(samples);
+  std::mutex mutex;
+  for (size_t i = 0; i < samples; ++i) {
+    // 间隔提交，每次探测队列的线程都处于等待状态
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    auto submitted = std::chrono::steady_clock::now();
+    probe->async([&latencies, &mutex, submitted]() {
+      auto latency = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - submitted).count();
+      std::lock_guard<std::mutex> lock(mutex);
+      latencies.push_back(latency);
+    });
+  }
+  probe->sync([]() {});
+  probe->fullTeardown();
+
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << std::setw(10) << loadName << std::setw(10) << qosName(probeClass) << std::setw(10)
+            << (canApply(probeClass) ? "yes" : "no") << std::fixed << std::setprecision(1) << std::setw(12)
+            << latencies[latencies.size() / 2] << std::setw(12) << latencies[latencies.size() * 99 / 100]
+            << std::setw(12) << latencies.back() << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500;
+  samples = std::max<size_t>(samples, 1);
+  size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1) * 2;
+
+  std::cout << "=== QoS wakeup latency benchmark (" << samples << " samples, load of " << threads
+            << " spinning threads) ===\n";
+  std::cout << "applied: whether this process may set the probe's QoS (raising priority needs CAP_SYS_NICE)\n";
+  std::cout << std::setw(10) << "load" << std::setw(10) << "probe" << std::setw(10) << "applied" << std::setw(12)
+            << "p50 us" << std::setw(12) << "p99 us" << std::setw(12) << "max us"
+            << "\n";
+
+  report("none", kThreadQoSClassNormal, samples);
+
+  struct Case {
+    ThreadQoSClass load;
+    ThreadQoSClass probe;
+  };
+  for (auto c : {Case{kThreadQoSClassNormal, kThreadQoSClassNormal}, Case{kThreadQoSClassNormal, kThreadQoSClassHigh},
+                 Case{kThreadQoSClassLow, kThreadQoSClassNormal}, Case{kThreadQoSClassLowest, kThreadQoSClassNormal},
+                 Case{kThreadQoSClassLowest, kThreadQoSClassHigh}}) {
+    BackgroundLoad load(c.load, threads);
+    report(qosName(c.load), c.probe, samples);
+  }
+
+  // kThreadQoSClassMax 使用 SCHED_FIFO 时抢占所有普通调度的线程
+  ThreadQoSConfig config;
+  config.realtimePolicy = RealtimePolicy::Fifo;
+  config.realtimePriority = 10;
+  ThreadQoS::setConfig(config);
+  std::cout << "\nmax with SCHED_FIFO (priority " << config.realtimePriority << "):\n";
+  {
+    BackgroundLoad load(kThreadQoSClassNormal, threads);
+    report("normal", kThreadQoSClassMax, samples);
+  }
+  return 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file serial_queue_benchmark.cpp
+ * @brief 大量串行队列：每队列一个线程 vs 复用线程池的 SerialDispatchQueue
+ *
+ * 模拟每个连接/会话一个串行队列的场景：
+ * - throughput: N 个队列各执行 M 个短任务（多个生产者交替提交），比较总耗时和进程线程数
+ * - fairness:   所有队列共享一个线程，一个队列积压大量任务的同时其余队列各提交一个任务，
+ *               测量这些任务的等待时间（批量上限让繁忙队列让出线程）
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dispatcher/DispatchGroup.h"
+#include "dispatcher/DispatchQueue.h"
+#include "dispatcher/ThreadPoolDispatchQueue.h"
+
+using namespace dispatch;
+
+namespace {
+
+constexpr size_t kProducers = 4;
+
+/// 当前进程的线程数（仅 Linux，其他平台返回 0）
+size_t processThreadCount() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 8, "Threads:") == 0) {
+      return std::strtoul(line.c_str() + 8, nullptr, 10);
+    }
+  }
+  return 0;
+}
+
+/// 每个队列的计数，按缓存行对齐避免伪共享
+struct alignas(64) Counter {
+  uint64_t value = 0;
+};
+
+void reportThroughput(const char* name, std::vector<std::shared_ptr<DispatchQueue>>& queues, size_t perQueue) {
+  std::vector<Counter> counters(queues.size());
+  DispatchGroup group;
+  size_t threads = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p]() {
+      for (size_t m = p; m < perQueue; m += kProducers) {
+        for (size_t q = 0; q < queues.size(); ++q) {
+          queues[q]->async(group, [&counters, q]() { counters[q].value++; });
+        }
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  threads = processThreadCount();
+  group.wait();
+  auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  auto total = queues.size() * perQueue;
+  std::cout << std::setw(14) << name << std::setw(10) << queues.size() << std::setw(12) << total << std::fixed
+            << std::setprecision(1) << std::setw(12) << elapsed << std::setw(14) << total / elapsed / 1000.0
+            << std::setw(10) << threads << "\n";
+}
+
+void reportFairness(const char* name, std::vector<std::shared_ptr<DispatchQueue>>& queues, size_t backlog) {
+  // 第一个队列积压 backlog 个任务
+  std::atomic<bool> release{false};
+  queues[0]->async([&release]() {
+    while (!release.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  });
+  for (size_t i = 0; i < backlog; ++i) {
+    queues[0]->async([]() {
+      volatile int sink = 0;
+      for (int k = 0; k < 200; ++k) {
+        sink = sink + k;
+      }
+    });
+  }
+
+  // 其余队列各提交一个任务，记录从提交到执行的时间
+  std::vector<double> latencies(queues.size() - 1);
+  DispatchGroup group;
+  release.store(true, std::memory_order_release);
+  for (size_t q = 1; q < queues.size(); ++q) {
+    auto submitted = std::chrono::steady_clock::now();
+    queues[q]->async(group, [&latencies, q, submitted]() {
+      latencies[q - 1] =
+          std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - submitted).count();
+    });
+  }
+  group.wait();
+  queues[0]->sync([]() {});
+
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << std::setw(14) << name << std::fixed << std::setprecision(1) << std::setw(12)
+            << latencies[latencies.size() / 2] << std::setw(12) << latencies[latencies.size() * 99 / 100]
+            << std::setw(12) << latencies.back() << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t queueCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+  size_t perQueue = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100;
+  queueCount = std::max<size_t>(queueCount, 2);
+  size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+  std::cout << "=== Serial queue benchmark (" << queueCount << " queues, " << perQueue << " tasks each, pool of "
+            << threads << " threads) ===\n";
+  std::cout << std::setw(14) << "queues" << std::setw(10) << "count" << std::setw(12) << "tasks" << std::setw(12)
+            << "ms" << std::setw(14) << "Mtasks/s" << std::setw(10) << "threads"
+            << "\n";
+
+  {
+    std::vector<std::shared_ptr<DispatchQueue>> queues;
+    for (size_t i = 0; i < queueCount; ++i) {
+      queues.push_back(DispatchQueue::createThreaded("Session", kThreadQoSClassNormal));
+    }
+    reportThroughput("threaded", queues, perQueue);
+    for (auto& queue : queues) {
+      queue->fullTeardown();
+    }
+  }
+
+  auto pool = ThreadPoolDispatchQueue::create("Sessions", threads);
+  {
+    std::vector<std::shared_ptr<DispatchQueue>> queues;
+    for (size_t i = 0; i < queueCount; ++i) {
+      queues.push_back(DispatchQueue::create("Session", pool));
+    }
+    reportThroughput("serial/pool", queues, perQueue);
+  }
+
+  pool->fullTeardown();
+
+  // 繁忙队列积压时其他队列的等待时间：批量上限越小，让出越频繁
+  // 使用单线程的线程池，让所有队列竞争同一个线程
+  auto single = ThreadPoolDispatchQueue::create("Fairness", 1);
+  std::cout << "\nLatency of idle queues sharing one thread with a queue that has a backlog of 100000 tasks (us):\n";
+  std::cout << std::setw(14) << "batch" << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "max"
+            << "\n";
+  for (size_t batch : {size_t(1), size_t(16), size_t(256), size_t(1000000)}) {
+    std::vector<std::shared_ptr<DispatchQueue>> queues;
+    for (size_t i = 0; i < std::min<size_t>(queueCount, 256); ++i) {
+      queues.push_back(DispatchQueue::create("Session", single, batch));
+    }
+    reportFairness(std::to_string(batch).c_str(), queues, 100000);
+  }
+
+  single->fullTeardown();
+  return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file wakeup_benchmark.cpp
+ * @brief 工作线程唤醒开销基准测试
+ *
+ * 向 1 到 32 个线程的线程池提交任务，统计每个任务引起的上下文切换次数（整个进程）。
+ * 每组分别测试：
+ * - sparse: 逐个提交，等上一个任务完成后再提交下一个（大部分线程空闲，最容易出现惊群）
+ * - burst:  一次提交一批任务，等待全部完成
+ *
+ * 上下文切换次数通过 getrusage 获取，仅在 POSIX 系统上可用。
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "dispatcher/ThreadPoolDispatchQueue.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define DISPATCHER_HAS_RUSAGE 1
+#endif
+
+using namespace dispatch;
+
+namespace {
+
+/// 当前进程累计的上下文切换次数（自愿 + 非自愿）
+long contextSwitches() {
+#ifdef DISPATCHER_HAS_RUSAGE
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_nvcsw + usage.ru_nivcsw;
+#else
+  return 0;
+#endif
+}
+
+struct Result {
+  double switchesPerTask;  ///< 每个任务的上下文切换次数
+  double microsPerTask;    ///< 每个任务的平均耗时（微秒）
+};
+
+/**
+ * @brief 运行一轮测试
+ * @param threads 线程池线程数
+ * @param tasks 任务总数
+ * @param batch 每批提交的任务数（1 表示逐个提交）
+ */
+Result run(size_t threads, size_t tasks, size_t batch) {
+  auto pool = ThreadPoolDispatchQueue::create("Wakeup", threads);
+
+  // 等待所有工作线程进入空闲状态
+  pool->sync([]() {});
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  std::atomic<size_t> executed{0};
+  auto switchesBefore = contextSwitches();
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t submitted = 0; submitted < tasks; submitted += batch) {
+    for (size_t i = 0; i < batch; ++i) {
+      pool->async([&executed]() { executed.fetch_add(1, std::memory_order_release); });
+    }
+    while (executed.load(std::memory_order_acquire) < submitted + batch) {
+      std::this_thread::yield();
+    }
+  }
+
+  auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  auto switches = contextSwitches() - switchesBefore;
+
+  pool->fullTeardown();
+  return {static_cast<double>(switches) / static_cast<double>(tasks), elapsed / static_cast<double>(tasks)};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  constexpr size_t kBurstSize = 64;
+
+#ifndef DISPATCHER_HAS_RUSAGE
+  std::cout << "note: context switch counts are not available on this platform\n";
+#endif
+
+  std::cout << "=== Worker wakeup benchmark (" << tasks << " tasks per run, burst size " << kBurstSize << ") ===\n";
+  std::cout << std::setw(8) << "threads" << std::setw(18) << "sparse csw/task" << std::setw(16) << "sparse us/task"
+            << std::setw(18) << "burst csw/task" << std::setw(16) << "burst us/task" << "\n";
+
+  for (size_t threads = 1; threads <= 32; threads *= 2) {
+    auto sparse = run(threads, tasks, 1);
+    auto burst = run(threads, tasks, kBurstSize);
+
+    std::cout << std::setw(8) << threads << std::fixed << std::setprecision(2) << std::setw(18)
+              << sparse.switchesPerTask << std::setw(16) << sparse.microsPerTask << std::setw(18)
+              << burst.switchesPerTask << std::setw(16) << burst.microsPerTask << "\n";
+  }
+
+  return 0;
+}
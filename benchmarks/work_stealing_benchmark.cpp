@@ -0,0 +1,167 @@
+/**
+ * @file work_stealing_benchmark.cpp
+ * @brief 线程池调度吞吐量基准测试
+ *
+ * 在 1 到 64 个线程的线程池上测量三种负载的吞吐量（每秒完成的任务数）：
+ * - fork-join:        递归二分任务树，每个节点在两个子任务都完成后才算完成（任务全部在工作线程内提交）
+ * - fire-and-forget (internal): 每个线程一个种子任务，在工作线程内连续提交大量互不相关的小任务
+ * - fire-and-forget (external): 一个外部线程连续提交大量互不相关的小任务
+ * - chain:            每个线程一条续延链，每个任务修改一块数据后提交下一个任务（数据应留在同一核心的缓存中）
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "dispatcher/ThreadPoolDispatchQueue.h"
+
+using namespace dispatch;
+
+namespace {
+
+/**
+ * @brief fork-join 的汇合点
+ *
+ * 两个子任务都完成后，汇合点自身完成并通知父节点。
+ */
+struct Join {
+  std::atomic<int> pending{2};  ///< 未完成的子任务数
+  Join* parent;                 ///< 父节点，根节点为 nullptr
+
+  explicit Join(Join* parent) : parent(parent) {}
+};
+
+void complete(Join* join, std::atomic<bool>* finished) {
+  while (join != nullptr) {
+    if (join->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    auto* parent = join->parent;
+    delete join;
+    join = parent;
+  }
+  finished->store(true, std::memory_order_release);
+}
+
+void fork(ThreadPoolDispatchQueue* pool, int depth, Join* parent, std::atomic<bool>* finished) {
+  if (depth == 0) {
+    complete(parent, finished);
+    return;
+  }
+  auto* join = new Join(parent);
+  pool->async([=]() { fork(pool, depth - 1, join, finished); });
+  pool->async([=]() { fork(pool, depth - 1, join, finished); });
+}
+
+template <typename F>
+void waitUntil(F&& done) {
+  while (!done()) {
+    std::this_thread::yield();
+  }
+}
+
+double seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// fork-join：深度为 depth 的任务树，共 2^(depth+1)-1 个任务
+double runForkJoin(ThreadPoolDispatchQueue* pool, int depth) {
+  std::atomic<bool> finished{false};
+  auto start = std::chrono::steady_clock::now();
+  pool->async([&]() { fork(pool, depth, nullptr, &finished); });
+  waitUntil([&]() { return finished.load(std::memory_order_acquire); });
+  auto tasks = static_cast<double>((size_t(1) << (depth + 1)) - 1);
+  return tasks / seconds(start);
+}
+
+/// fire-and-forget：在工作线程内提交任务
+double runInternal(ThreadPoolDispatchQueue* pool, size_t tasks) {
+  std::atomic<size_t> executed{0};
+  auto seeds = pool->threadCount();
+  auto perSeed = tasks / seeds;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t s = 0; s < seeds; ++s) {
+    pool->async([&, perSeed]() {
+      for (size_t i = 0; i < perSeed; ++i) {
+        pool->async([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+      }
+    });
+  }
+  waitUntil([&]() { return executed.load(std::memory_order_relaxed) == perSeed * seeds; });
+  return static_cast<double>(perSeed * seeds) / seconds(start);
+}
+
+/// 续延链中每个任务读写的数据量
+constexpr size_t kChainBytes = 16 * 1024;
+
+void chainStep(ThreadPoolDispatchQueue* pool, std::vector<unsigned char>* data, size_t remaining,
+               std::atomic<size_t>* executed) {
+  for (auto& byte : *data) {
+    byte++;
+  }
+  executed->fetch_add(1, std::memory_order_relaxed);
+  if (remaining > 1) {
+    pool->async([=]() { chainStep(pool, data, remaining - 1, executed); });
+  }
+}
+
+/// 续延链：每个线程一条链，任务依次提交下一个任务
+double runChain(ThreadPoolDispatchQueue* pool, size_t tasks) {
+  std::atomic<size_t> executed{0};
+  auto chains = pool->threadCount();
+  auto length = tasks / chains / 16;
+  std::vector<std::vector<unsigned char>> data(chains, std::vector<unsigned char>(kChainBytes));
+  auto start = std::chrono::steady_clock::now();
+  for (size_t c = 0; c < chains; ++c) {
+    auto* chainData = &data[c];
+    pool->async([=, &executed]() { chainStep(pool, chainData, length, &executed); });
+  }
+  waitUntil([&]() { return executed.load(std::memory_order_relaxed) == length * chains; });
+  return static_cast<double>(length * chains) / seconds(start);
+}
+
+/// fire-and-forget：从外部线程提交任务
+double runExternal(ThreadPoolDispatchQueue* pool, size_t tasks) {
+  std::atomic<size_t> executed{0};
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < tasks; ++i) {
+    pool->async([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+  }
+  waitUntil([&]() { return executed.load(std::memory_order_relaxed) == tasks; });
+  return static_cast<double>(tasks) / seconds(start);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+  int depth = 0;
+  while ((size_t(2) << (depth + 1)) <= tasks) {
+    depth++;
+  }
+
+  std::cout << "=== Thread pool scheduling benchmark (Mtasks/s, ~" << tasks << " tasks per run) ===\n";
+  std::cout << std::setw(8) << "threads" << std::setw(14) << "fork-join" << std::setw(14) << "ff-internal"
+            << std::setw(14) << "ff-external" << std::setw(14) << "chain" << "\n";
+
+  for (size_t threads = 1; threads <= 64; threads *= 2) {
+    auto pool = ThreadPoolDispatchQueue::create("WorkStealing", threads);
+    pool->sync([]() {});
+
+    auto forkJoin = runForkJoin(pool.get(), depth);
+    auto internal = runInternal(pool.get(), tasks);
+    auto external = runExternal(pool.get(), tasks);
+    auto chain = runChain(pool.get(), tasks);
+    pool->fullTeardown();
+
+    std::cout << std::setw(8) << threads << std::fixed << std::setprecision(2) << std::setw(14) << forkJoin / 1e6
+              << std::setw(14) << internal / 1e6 << std::setw(14) << external / 1e6 << std::setw(14) << chain / 1e6
+              << "\n";
+  }
+
+  return 0;
+}
@@ -6,11 +6,12 @@
  */
 
 #include <chrono>
-#include <future>
 #include <iostream>
 #include <optional>
+#include <string>
 
 #include "dispatcher/DispatchQueue.h"
+#include "dispatcher/Future.h"
 
 using namespace dispatch;
 using namespace std::chrono_literals;
@@ -23,22 +24,8 @@ class AsyncTask {
  public:
   AsyncTask(std::shared_ptr<DispatchQueue> queue) : m_queue(queue) {}
 
-  // 执行异步任务并返回 future
-  std::future<T> execute(std::function<T()> task) {
-    auto promise = std::make_shared<std::promise<T>>();
-    auto future = promise->get_future();
-
-    m_queue->async([promise, task]() {
-      try {
-        T result = task();
-        promise->set_value(result);
-      } catch (...) {
-        promise->set_exception(std::current_exception());
-      }
-    });
-
-    return future;
-  }
+  // 执行异步任务并返回 future（共享状态一次分配，任务抛出的异常由 get() 重新抛出）
+  Future<T> execute(std::function<T()> task) { return asyncValue(m_queue, std::move(task)); }
 
  private:
   std::shared_ptr<DispatchQueue> m_queue;
@@ -79,40 +66,26 @@ class BatchProcessor {
  public:
   BatchProcessor(std::shared_ptr<DispatchQueue> queue) : m_queue(queue) {}
 
-  // 批量提交任务，等待全部完成
+  // 批量提交任务，等待全部完成（只等待这一批任务，不影响队列中的其他任务）
   void processBatch(const std::vector<std::function<void()>>& tasks) {
-    std::atomic<size_t> completed{0};
-    size_t total = tasks.size();
-
+    DispatchGroup group;
     for (const auto& task : tasks) {
-      m_queue->async([task, &completed]() {
-        task();
-        completed++;
-      });
-    }
-
-    // 等待所有任务完成
-    while (completed < total) {
-      std::this_thread::sleep_for(10ms);
+      m_queue->async(group, task);
     }
+    group.wait();
   }
 
   // 并行处理数组
   template <typename T, typename Func>
   std::vector<T> map(const std::vector<T>& input, Func func) {
     std::vector<T> results(input.size());
-    std::atomic<size_t> completed{0};
+    DispatchGroup group;
 
     for (size_t i = 0; i < input.size(); ++i) {
-      m_queue->async([&input, &results, &completed, i, func]() {
-        results[i] = func(input[i]);
-        completed++;
-      });
+      m_queue->async(group, [&input, &results, i, func]() { results[i] = func(input[i]); });
     }
 
-    while (completed < input.size()) {
-      std::this_thread::sleep_for(1ms);
-    }
+    group.wait();
 
     return results;
   }
@@ -221,8 +194,7 @@ int main() {
     });
 
     // 尝试等待100ms
-    auto status = future.wait_for(100ms);
-    if (status == std::future_status::timeout) {
+    if (!future.wait(100ms)) {
       std::cout << "  Task timed out (still running)\n";
     } else {
       std::cout << "  Task completed: " << future.get() << "\n";
@@ -232,6 +204,26 @@ int main() {
     std::cout << "  Waiting for completion... Result: " << future.get() << "\n";
   }
 
+  // 7. 续延流水线：每一步在结果就绪后投递到队列，没有线程阻塞在中间结果上
+  std::cout << "\n7. Continuation Pipeline:\n";
+  {
+    std::vector<Future<int>> parts;
+    for (int i = 1; i <= 4; ++i) {
+      parts.push_back(asyncValue(queue, [i]() { return i * 10; }));
+    }
+
+    auto total = whenAll(parts)
+                     .then(queue,
+                           [](const std::vector<int>& values) {
+                             int sum = 0;
+                             for (int v : values) sum += v;
+                             return sum;
+                           })
+                     .then(queue, [](int sum) { return "sum = " + std::to_string(sum); });
+
+    std::cout << "  " << total.get() << "\n";
+  }
+
   queue->flushAndTeardown();
   std::cout << "\n=== Example completed ===\n";
   return 0;
@@ -0,0 +1,118 @@
+/**
+ * @file coroutine_example.cpp
+ * @brief 协程示例
+ *
+ * 演示如何用 C++20 协程在队列之间切换，替代回调嵌套和 promise/future：
+ * co_await queue->schedule()、co_await queue->after(delay)、Task<T> 与 spawn()。
+ * 需要以 -Ddispatcher_ENABLE_COROUTINES=ON 构建。
+ */
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dispatcher/Coroutine.h"
+#include "dispatcher/DispatchQueue.h"
+#include "dispatcher/ThreadPoolDispatchQueue.h"
+
+using namespace dispatch;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::mutex g_printMutex;
+
+void log(const std::string& message) {
+  std::lock_guard<std::mutex> lock(g_printMutex);
+  std::cout << "  [" << std::this_thread::get_id() << "] " << message << "\n";
+}
+
+// 在线程池上计算，子任务以 Task<int> 返回结果
+Task<int> computeSquare(std::shared_ptr<ThreadPoolDispatchQueue> pool, int value) {
+  co_await pool->schedule();
+  std::ostringstream ss;
+  ss << "computing " << value << " * " << value << " on the pool";
+  log(ss.str());
+  co_return value * value;
+}
+
+// 在 IO 队列读取、线程池计算、UI 队列展示，每一步都是普通的顺序代码
+Task<std::string> pipeline(std::shared_ptr<DispatchQueue> io, std::shared_ptr<ThreadPoolDispatchQueue> pool,
+                           std::shared_ptr<DispatchQueue> ui) {
+  co_await io->schedule();
+  log("loading input on the IO queue");
+  std::vector<int> input = {1, 2, 3, 4};
+
+  co_await io->after(50ms);
+  log("resumed on the IO queue after 50ms");
+
+  int sum = 0;
+  for (int value : input) {
+    sum += co_await computeSquare(pool, value);
+  }
+
+  // 等待普通的 asyncValue 结果，不阻塞线程
+  int offset = co_await asyncValue(pool, []() { return 100; });
+
+  co_await ui->schedule();
+  std::string text = "sum of squares + offset = " + std::to_string(sum + offset);
+  log("presenting on the UI queue: " + text);
+  co_return text;
+}
+
+// 协程中抛出的异常通过 Future 传递给调用方
+Task<void> failing(std::shared_ptr<DispatchQueue> queue) {
+  co_await queue->schedule();
+  throw std::runtime_error("coroutine failed");
+}
+
+}  // namespace
+
+int main() {
+  std::cout << "=== Coroutine Example ===\n\n";
+
+  auto io = DispatchQueue::createThreaded("IO", kThreadQoSClassNormal);
+  auto ui = DispatchQueue::createThreaded("UI", kThreadQoSClassHigh);
+  auto pool = ThreadPoolDispatchQueue::create("Pool", 4);
+
+  // 1. 在多个队列之间切换
+  std::cout << "1. Hopping between queues:\n";
+  {
+    auto result = spawn(pool, pipeline(io, pool, ui));
+    auto text = result.get();
+    std::cout << "  Result: " << text << "\n";
+  }
+
+  // 2. 并发启动多个协程，用 whenAll 汇总
+  std::cout << "\n2. Fan-out with spawn + whenAll:\n";
+  {
+    std::vector<Future<int>> results;
+    for (int i = 1; i <= 4; ++i) {
+      results.push_back(spawn(pool, computeSquare(pool, i * 10)));
+    }
+    auto all = whenAll(results);
+    for (int value : all.get()) {
+      std::cout << "  " << value << "\n";
+    }
+  }
+
+  // 3. 异常传递
+  std::cout << "\n3. Error propagation:\n";
+  {
+    try {
+      spawn(io, failing(io)).get();
+    } catch (const std::exception& e) {
+      std::cout << "  Caught exception: " << e.what() << "\n";
+    }
+  }
+
+  pool->flushAndTeardown();
+  ui->flushAndTeardown();
+  io->flushAndTeardown();
+  std::cout << "\n=== Example completed ===\n";
+  return 0;
+}
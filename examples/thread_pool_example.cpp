@@ -12,7 +12,10 @@
 #include <mutex>
 #include <sstream>
 #include <thread>
+#include <vector>
 
+#include "dispatcher/DispatchGroup.h"
+#include "dispatcher/DispatchQueue.h"
 #include "dispatcher/ThreadPoolDispatchQueue.h"
 
 using namespace dispatch;
@@ -44,12 +47,12 @@ void example1_basicConcurrency() {
   auto pool = ThreadPoolDispatchQueue::create("worker-pool", 4);
   std::cout << "Created thread pool with " << pool->threadCount() << " threads\n\n";
 
-  std::atomic<int> completed{0};
+  DispatchGroup group;
   const int taskCount = 8;
 
   // Submit tasks that simulate work
   for (int i = 0; i < taskCount; ++i) {
-    pool->async([i, &completed]() {
+    pool->async(group, [i]() {
       std::stringstream ss;
       ss << "[" << getTimestamp() << "] Task " << i << " started on thread " << std::this_thread::get_id() << "\n";
       safePrint(ss.str());
@@ -60,15 +63,11 @@ void example1_basicConcurrency() {
       ss.str("");
       ss << "[" << getTimestamp() << "] Task " << i << " completed\n";
       safePrint(ss.str());
-
-      completed++;
     });
   }
 
   // Wait for all tasks to complete
-  while (completed < taskCount) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-  }
+  group.wait();
 
   std::cout << "\nAll " << taskCount << " tasks completed.\n";
   std::cout << "With 4 threads and 500ms tasks, 8 tasks should complete in ~1 second.\n";
@@ -79,56 +78,38 @@ void example1_basicConcurrency() {
 // Example 2: CPU-bound parallel processing
 // ========================================================================
 void example2_parallelProcessing() {
-  std::cout << "\n=== Example 2: Parallel Processing ===\n";
+  std::cout << "\n=== Example 2: Parallel Processing (parallelFor) ===\n";
 
   auto pool = ThreadPoolDispatchQueue::create("compute-pool", 4);
 
-  // Compute sum in parallel
-  const int rangeCount = 4;
-  const int numbersPerRange = 10000000;
-  std::atomic<long long> partialSums[rangeCount];
-  std::atomic<int> completed{0};
-
-  for (int i = 0; i < rangeCount; ++i) {
-    partialSums[i] = 0;
-  }
+  // Compute sum in parallel: split into blocks, each block writes its own partial sum
+  const int blockCount = 64;
+  const long long numbersPerBlock = 625000;
+  std::vector<long long> partialSums(blockCount, 0);
 
   auto startTime = std::chrono::steady_clock::now();
 
-  for (int range = 0; range < rangeCount; ++range) {
-    pool->async([range, numbersPerRange, &partialSums, &completed]() {
-      long long sum = 0;
-      int start = range * numbersPerRange;
-      int end = start + numbersPerRange;
-
-      for (int i = start; i < end; ++i) {
-        sum += i;
-      }
-
-      partialSums[range] = sum;
-      completed++;
-
-      std::stringstream ss;
-      ss << "Range " << range << " computed: sum = " << sum << "\n";
-      safePrint(ss.str());
-    });
-  }
-
-  // Wait for completion
-  while (completed < rangeCount) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-  }
+  // parallelFor returns when all iterations are done; the calling thread helps instead of waiting
+  pool->parallelFor(0, blockCount, [&partialSums, numbersPerBlock](int block) {
+    long long sum = 0;
+    long long start = block * numbersPerBlock;
+    long long end = start + numbersPerBlock;
+    for (long long i = start; i < end; ++i) {
+      sum += i;
+    }
+    partialSums[block] = sum;
+  });
 
   // Aggregate results
   long long totalSum = 0;
-  for (int i = 0; i < rangeCount; ++i) {
-    totalSum += partialSums[i];
+  for (auto sum : partialSums) {
+    totalSum += sum;
   }
 
   auto endTime = std::chrono::steady_clock::now();
   auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
 
-  std::cout << "Total sum of 0 to " << (rangeCount * numbersPerRange - 1) << " = " << totalSum << "\n";
+  std::cout << "Total sum of 0 to " << (blockCount * numbersPerBlock - 1) << " = " << totalSum << "\n";
   std::cout << "Parallel computation time: " << duration << "ms\n";
 }
 
@@ -144,20 +125,17 @@ void example3_serialVsParallel() {
   // Serial execution (1 thread)
   {
     auto serialQueue = ThreadPoolDispatchQueue::create("serial", 1);
-    std::atomic<int> completed{0};
+    DispatchGroup group;
 
     auto startTime = std::chrono::steady_clock::now();
 
     for (int i = 0; i < taskCount; ++i) {
-      serialQueue->async([&completed, taskDurationMs]() {
+      serialQueue->async(group, [taskDurationMs]() {
         std::this_thread::sleep_for(std::chrono::milliseconds(taskDurationMs));
-        completed++;
       });
     }
 
-    while (completed < taskCount) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    }
+    group.wait();
 
     auto endTime = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
@@ -169,20 +147,17 @@ void example3_serialVsParallel() {
   // Parallel execution (4 threads)
   {
     auto parallelPool = ThreadPoolDispatchQueue::create("parallel", 4);
-    std::atomic<int> completed{0};
+    DispatchGroup group;
 
     auto startTime = std::chrono::steady_clock::now();
 
     for (int i = 0; i < taskCount; ++i) {
-      parallelPool->async([&completed, taskDurationMs]() {
+      parallelPool->async(group, [taskDurationMs]() {
         std::this_thread::sleep_for(std::chrono::milliseconds(taskDurationMs));
-        completed++;
       });
     }
 
-    while (completed < taskCount) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    }
+    group.wait();
 
     auto endTime = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
@@ -199,7 +174,7 @@ void example4_delayedTasks() {
   std::cout << "\n=== Example 4: Delayed Tasks in Thread Pool ===\n";
 
   auto pool = ThreadPoolDispatchQueue::create("delayed-pool", 4);
-  std::atomic<int> completed{0};
+  DispatchGroup group;
 
   auto startTime = std::chrono::steady_clock::now();
 
@@ -207,7 +182,8 @@ void example4_delayedTasks() {
   for (int i = 0; i < 4; ++i) {
     auto delay = std::chrono::milliseconds(i * 200);
     pool->asyncAfter(
-        [i, startTime, &completed]() {
+        group,
+        [i, startTime]() {
           auto elapsed =
               std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime)
                   .count();
@@ -215,16 +191,13 @@ void example4_delayedTasks() {
           std::stringstream ss;
           ss << "Task " << i << " executed at " << elapsed << "ms (delay: " << i * 200 << "ms)\n";
           safePrint(ss.str());
-
-          completed++;
         },
         delay);
   }
 
-  // Wait for completion
-  while (completed < 4) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-  }
+  // Continuation runs on the pool once the last delayed task finishes; wait() only blocks this thread
+  group.notify(pool, []() { safePrint("Group notify: all delayed tasks finished\n"); });
+  group.wait();
 
   std::cout << "All delayed tasks completed.\n";
 }
@@ -260,6 +233,80 @@ void example5_syncOperation() {
   std::cout << "After sync(), counter = " << counter << "\n";
 }
 
+// ========================================================================
+// Example 6: Elastic thread pool
+// ========================================================================
+void example6_elasticPool() {
+  std::cout << "\n=== Example 6: Elastic Thread Pool ===\n";
+
+  // Start with 1 thread, grow up to 8 under load, retire idle threads after 200ms
+  ThreadPoolOptions options;
+  options.minThreads = 1;
+  options.maxThreads = 8;
+  options.idleTimeout = std::chrono::milliseconds(200);
+  auto pool = ThreadPoolDispatchQueue::create("elastic-pool", options);
+
+  auto printStats = [&pool](const char* label) {
+    auto stats = pool->stats();
+    std::cout << label << ": threads=" << stats.threads << " spawned=" << stats.spawned
+              << " retired=" << stats.retired << "\n";
+  };
+  printStats("Initial");
+
+  // A burst of blocking tasks builds up a backlog, the pool grows
+  std::atomic<int> completed{0};
+  const int taskCount = 40;
+  for (int i = 0; i < taskCount; ++i) {
+    pool->async([&completed]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      completed++;
+    });
+  }
+  while (completed < taskCount) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  printStats("After burst");
+
+  // Extra threads retire once they have been idle for the timeout
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  printStats("After idle");
+}
+
+// ========================================================================
+// Example 7: Many serial queues sharing one pool
+// ========================================================================
+void example7_serialQueues() {
+  std::cout << "\n=== Example 7: Serial Queues on a Shared Pool ===\n";
+
+  // One serial queue per session; none of them owns a thread
+  auto pool = ThreadPoolDispatchQueue::create("session-pool", 4);
+  constexpr int sessionCount = 1000;
+  constexpr int messagesPerSession = 20;
+  std::vector<std::shared_ptr<DispatchQueue>> sessions;
+  std::vector<int> lastMessage(sessionCount, -1);
+  std::atomic<int> outOfOrder{0};
+  for (int i = 0; i < sessionCount; ++i) {
+    sessions.push_back(DispatchQueue::create("session", pool));
+  }
+
+  // Messages of one session run in order and never concurrently, so lastMessage needs no lock
+  DispatchGroup group;
+  for (int m = 0; m < messagesPerSession; ++m) {
+    for (int i = 0; i < sessionCount; ++i) {
+      sessions[i]->async(group, [i, m, &lastMessage, &outOfOrder]() {
+        if (lastMessage[i] != m - 1) {
+          outOfOrder++;
+        }
+        lastMessage[i] = m;
+      });
+    }
+  }
+  group.wait();
+
+  std::cout << sessionCount << " sessions x " << messagesPerSession << " messages on " << pool->threadCount()
+            << " threads, out of order: " << outOfOrder << "\n";
+}
+
 int main() {
   std::cout << "ThreadPoolDispatchQueue Examples\n";
   std::cout << "================================\n";
@@ -270,6 +317,8 @@ int main() {
   example3_serialVsParallel();
   example4_delayedTasks();
   example5_syncOperation();
+  example6_elasticPool();
+  example7_serialQueues();
 
   std::cout << "\n=== All examples completed ===\n";
   return 0;
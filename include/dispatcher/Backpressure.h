@@ -0,0 +1,35 @@
+/**
+ * @file Backpressure.h
+ * @brief 有界队列的溢出策略与统计
+ *
+ * 队列可以设置容量（等待执行的任务数上限）。下游处理变慢时，生产者按溢出策略被阻塞，
+ * 或者丢弃任务，而不是让队列无限增长耗尽内存。
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace dispatch {
+
+/**
+ * @brief 队列已满时 async 等提交操作的处理方式
+ *
+ * tryAsync 不受此策略影响：队列已满时总是立即返回 false。
+ */
+enum class OverflowPolicy : uint8_t {
+  Block,       ///< 阻塞生产者（在条件变量上等待，不自旋），直到有任务开始执行腾出空间（默认）
+  DropOldest,  ///< 丢弃最早排队的就绪任务（从最低优先级的通道开始），为新任务腾出空间
+  DropNewest,  ///< 丢弃新提交的任务
+};
+
+/**
+ * @brief 有界队列的统计信息（自队列创建起累计）
+ */
+struct OverflowStats {
+  uint64_t blocked = 0;   ///< 因队列已满而阻塞等待的提交次数
+  uint64_t rejected = 0;  ///< 因队列已满而返回 false 的 tryAsync 次数
+  uint64_t dropped = 0;   ///< 按 DropOldest/DropNewest 丢弃的任务数
+};
+
+}  // namespace dispatch
@@ -0,0 +1,64 @@
+/**
+ * @file ClosureAllocator.h
+ * @brief 任务闭包的池化分配器
+ *
+ * 为超出 TaskFunction 内联缓冲区的闭包提供内存，稳态下不调用 malloc/free。
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "SlabAllocator.h"
+
+namespace dispatch {
+
+/**
+ * @brief 任务闭包的池化分配器
+ *
+ * 结构：
+ * - 按大小分为若干级别（64/128/256/512 字节），每个级别一个由互斥锁保护的 SlabAllocator
+ * - 每个线程为每个级别保留一个空闲块缓存，分配和释放通常只访问线程缓存
+ * - 线程缓存为空时从 slab 批量取块，超过上限时批量归还，互斥锁的开销被摊薄
+ * - 块可以在任意线程释放（例如在提交线程分配、在工作线程释放）
+ *
+ * 超过 kMaxPooledSize 的闭包直接使用 operator new。
+ */
+class ClosureAllocator {
+ public:
+  /// 池化的最大闭包大小
+  static constexpr size_t kMaxPooledSize = 512;
+
+  ClosureAllocator() = delete;
+
+  /**
+   * @brief 分配闭包内存
+   * @param size 字节数
+   * @return void* 按 alignof(std::max_align_t) 对齐的内存
+   */
+  static void* allocate(size_t size);
+
+  /**
+   * @brief 释放闭包内存
+   * @param memory 由 allocate() 返回的内存
+   * @param size 分配时的字节数
+   */
+  static void deallocate(void* memory, size_t size) noexcept;
+
+  /**
+   * @brief 设置每个大小级别保留的空闲 slab 数量上限（高水位）
+   * @param maxRetainedSlabs 上限
+   */
+  static void setMaxRetainedSlabs(size_t maxRetainedSlabs);
+
+  /**
+   * @brief 获取所有大小级别的汇总统计信息
+   *
+   * 线程缓存中的空闲块计为使用中。
+   *
+   * @return AllocatorStats 统计信息
+   */
+  static AllocatorStats stats();
+};
+
+}  // namespace dispatch
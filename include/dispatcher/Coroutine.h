@@ -0,0 +1,305 @@
+/**
+ * @file Coroutine.h
+ * @brief C++20 协程支持
+ *
+ * 让协程在调度队列之间切换：
+ * - co_await queue->schedule()：在 queue 上恢复执行
+ * - co_await queue->after(delay)：延迟 delay 后在 queue 上恢复执行
+ * - Task<T>：惰性启动的协程，可以在其他协程中 co_await，也可以通过 spawn() 投递到队列执行
+ * - co_await future：等待 Future 就绪（在完成结果的线程上恢复）
+ *
+ * 恢复操作基于 async/asyncAfter 实现，因此适用于所有队列类型。
+ * 需要以 dispatcher_ENABLE_COROUTINES=ON 构建（启用 C++20）。
+ */
+
+#pragma once
+
+#if !defined(DISPATCHER_COROUTINES)
+#error "dispatcher/Coroutine.h requires building with -Ddispatcher_ENABLE_COROUTINES=ON"
+#endif
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "Future.h"
+#include "IDispatchQueue.h"
+
+namespace dispatch {
+
+/**
+ * @brief co_await queue->schedule() 的等待器
+ *
+ * 总是挂起，并通过 async 把协程的恢复投递到队列。
+ * 队列被销毁时未执行的恢复任务会被丢弃，挂起的协程不会再恢复，
+ * 因此应在协程结束之后再销毁队列（例如先等待 spawn() 返回的 Future）。
+ */
+class ScheduleAwaiter {
+ public:
+  explicit ScheduleAwaiter(IDispatchQueue* queue) : queue_(queue) {}
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> handle) const {
+    queue_->async([handle]() { handle.resume(); });
+  }
+  void await_resume() const noexcept {}
+
+ private:
+  IDispatchQueue* queue_;  ///< 恢复协程的队列
+};
+
+/**
+ * @brief co_await queue->after(delay) 的等待器
+ *
+ * 通过 asyncAfter 在 delay 之后把协程的恢复投递到队列。
+ */
+class AfterAwaiter {
+ public:
+  AfterAwaiter(IDispatchQueue* queue, std::chrono::steady_clock::duration delay) : queue_(queue), delay_(delay) {}
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> handle) const {
+    queue_->asyncAfter([handle]() { handle.resume(); }, delay_);
+  }
+  void await_resume() const noexcept {}
+
+ private:
+  IDispatchQueue* queue_;                      ///< 恢复协程的队列
+  std::chrono::steady_clock::duration delay_;  ///< 延迟时间
+};
+
+inline ScheduleAwaiter IDispatchQueue::schedule() { return ScheduleAwaiter(this); }
+
+inline AfterAwaiter IDispatchQueue::after(std::chrono::steady_clock::duration delay) {
+  return AfterAwaiter(this, delay);
+}
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+/**
+ * @brief Task 协程的 promise 公共部分
+ *
+ * 协程创建后立即挂起（惰性启动），结束时通过对称转移直接恢复等待它的协程，不经过队列。
+ */
+class TaskPromiseBase {
+ public:
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept {
+      auto continuation = handle.promise().continuation_;
+      return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+  void setContinuation(std::coroutine_handle<> continuation) noexcept { continuation_ = continuation; }
+
+ protected:
+  std::coroutine_handle<> continuation_;  ///< 等待本协程结束的协程
+  std::exception_ptr exception_;          ///< 协程抛出的异常
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+ public:
+  Task<T> get_return_object() noexcept;
+
+  template <typename U>
+  void return_value(U&& value) {
+    value_.emplace(std::forward<U>(value));
+  }
+
+  T result() {
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+    return std::move(*value_);
+  }
+
+ private:
+  std::optional<T> value_;  ///< 协程的返回值
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+ public:
+  Task<void> get_return_object() noexcept;
+
+  void return_void() const noexcept {}
+
+  void result() {
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+};
+
+}  // namespace detail
+
+/**
+ * @brief 协程任务
+ *
+ * 仅可移动，拥有协程帧。创建后不会立即执行：
+ * - 在另一个协程中 co_await task：启动并等待结果，结束后直接在完成的线程上恢复等待方
+ * - spawn(queue, std::move(task))：在 queue 上启动，结果通过 Future 返回
+ *
+ * 使用示例：
+ * @code
+ * Task<int> loadAndParse(std::shared_ptr<DispatchQueue> io, std::shared_ptr<DispatchQueue> ui) {
+ *   co_await io->schedule();           // 切换到 IO 队列
+ *   auto data = readFile("data.bin");
+ *   co_await ui->after(10ms);          // 10ms 后在 UI 队列上继续
+ *   co_return parse(data);
+ * }
+ *
+ * auto result = spawn(pool, loadAndParse(io, ui));
+ * @endcode
+ *
+ * @tparam T 返回值类型，可以是 void
+ */
+template <typename T>
+class Task {
+ public:
+  using promise_type = detail::TaskPromise<T>;
+
+  Task() noexcept = default;
+  Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      if (handle_) {
+        handle_.destroy();
+      }
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+  ~Task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  /**
+   * @brief 是否关联了协程
+   */
+  bool valid() const noexcept { return static_cast<bool>(handle_); }
+
+  /**
+   * @brief 启动协程并等待其结束，返回协程的结果（或重新抛出其异常）
+   */
+  auto operator co_await() noexcept {
+    struct Awaiter {
+      std::coroutine_handle<promise_type> handle;
+
+      bool await_ready() const noexcept { return !handle || handle.done(); }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) const noexcept {
+        handle.promise().setContinuation(continuation);
+        return handle;
+      }
+      T await_resume() const { return handle.promise().result(); }
+    };
+    return Awaiter{handle_};
+  }
+
+ private:
+  friend class detail::TaskPromise<T>;
+
+  explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;  ///< 协程帧
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+  return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+  return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/// 立即启动、结束时自行销毁的协程，用于 spawn()
+struct DetachedCoroutine {
+  struct promise_type {
+    DetachedCoroutine get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+template <typename T>
+DetachedCoroutine runSpawned(std::shared_ptr<IDispatchQueue> queue, Task<T> task, Promise<T> promise) {
+  co_await queue->schedule();
+  try {
+    if constexpr (std::is_void<T>::value) {
+      co_await task;
+      promise.setValue();
+    } else {
+      promise.setValue(co_await task);
+    }
+  } catch (...) {
+    promise.setException(std::current_exception());
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief 在队列上启动协程任务
+ *
+ * 协程的第一段在 queue 上执行，之后在哪个队列恢复由协程内部的 co_await 决定。
+ * 协程的返回值（或异常）写入返回的 Future；结果不需要时可以忽略返回值。
+ *
+ * @param queue 启动协程的队列
+ * @param task 协程任务（将被移动）
+ * @return Future 协程的结果
+ */
+template <typename T>
+Future<T> spawn(const std::shared_ptr<IDispatchQueue>& queue, Task<T> task) {
+  Promise<T> promise;
+  auto result = promise.future();
+  detail::runSpawned(queue, std::move(task), std::move(promise));
+  return result;
+}
+
+/**
+ * @brief 在协程中等待 Future 就绪
+ *
+ * 协程在写入结果的线程上恢复（已就绪时不挂起）；需要回到特定队列时，随后 co_await queue->schedule()。
+ *
+ * @param future 要等待的 Future
+ * @return 结果的常量引用（void 时无返回值），Future 以异常结束时重新抛出
+ */
+template <typename T>
+auto operator co_await(const Future<T>& future) noexcept {
+  struct Awaiter {
+    Future<T> future;
+
+    bool await_ready() const noexcept { return future.isReady(); }
+    void await_suspend(std::coroutine_handle<> handle) const {
+      future.onReady([handle]() { handle.resume(); });
+    }
+    decltype(auto) await_resume() const { return future.get(); }
+  };
+  return Awaiter{future};
+}
+
+}  // namespace dispatch
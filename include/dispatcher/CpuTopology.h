@@ -0,0 +1,99 @@
+/**
+ * @file CpuTopology.h
+ * @brief CPU 拓扑与线程绑定
+ *
+ * 从 /sys 读取 CPU 的核心、物理封装和 NUMA 节点信息，生成工作线程的 CPU 布局，
+ * 并通过 sched_setaffinity 绑定线程。由 ThreadPoolDispatchQueue 内部使用。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace dispatch {
+
+/**
+ * @brief 工作线程的 CPU 布局方式
+ */
+enum class WorkerPlacement {
+  None,    ///< 不绑定单个 CPU（指定了 CPU 集合时绑定到整个集合）
+  Spread,  ///< 分散：依次轮流使用各 NUMA 节点，同一节点内先占满物理核心再使用超线程
+  Pack,    ///< 紧凑：占满一个 NUMA 节点（同一核心的超线程相邻）后再使用下一个节点
+};
+
+/**
+ * @brief 单个逻辑 CPU 的拓扑信息
+ */
+struct CpuInfo {
+  int cpu = 0;      ///< 逻辑 CPU 编号
+  int core = 0;     ///< 核心编号（同一物理封装内唯一）
+  int package = 0;  ///< 物理封装（插槽）编号
+  size_t node = 0;  ///< NUMA 节点序号（从 0 开始连续编号）
+};
+
+/**
+ * @brief CPU 拓扑
+ *
+ * 只在 Linux 上读取 /sys/devices/system；其他平台或读取失败时退化为
+ * 单个 NUMA 节点、每个逻辑 CPU 一个核心，线程绑定为空操作。
+ */
+class CpuTopology {
+ public:
+  /**
+   * @brief 读取当前系统的 CPU 拓扑（只包含在线的 CPU）
+   * @return CpuTopology 拓扑信息
+   */
+  static CpuTopology detect();
+
+  /**
+   * @brief 获取所有逻辑 CPU 的信息（按 CPU 编号排序）
+   */
+  const std::vector<CpuInfo>& cpus() const { return cpus_; }
+
+  /**
+   * @brief 获取 NUMA 节点数量（至少为 1）
+   */
+  size_t nodeCount() const { return node_count_; }
+
+  /**
+   * @brief 获取逻辑 CPU 所在的 NUMA 节点序号
+   * @param cpu 逻辑 CPU 编号
+   * @return size_t 节点序号，未知的 CPU 返回 0
+   */
+  size_t nodeOf(int cpu) const;
+
+  /**
+   * @brief 按布局方式对 CPU 排序
+   * @param placement 布局方式（None 时按 CPU 编号排序）
+   * @param allowed 允许使用的 CPU，为空时使用调用线程当前允许的 CPU
+   * @return std::vector<int> 排好序的 CPU 编号，第 i 个工作线程使用第 i % size 个
+   */
+  std::vector<int> layout(WorkerPlacement placement, const std::vector<int>& allowed) const;
+
+  /**
+   * @brief 获取调用线程当前允许运行的 CPU
+   * @return std::vector<int> CPU 编号，无法获取时返回空
+   */
+  static std::vector<int> currentAffinity();
+
+  /**
+   * @brief 将调用线程绑定到给定的 CPU 集合
+   * @param cpus CPU 编号
+   * @return true 绑定成功
+   */
+  static bool bindCurrentThread(const std::vector<int>& cpus);
+
+  /**
+   * @brief 获取调用线程当前所在的逻辑 CPU
+   * @return int CPU 编号，无法获取时返回 -1
+   */
+  static int currentCpu();
+
+ private:
+  std::vector<CpuInfo> cpus_;      ///< 逻辑 CPU 信息
+  std::vector<size_t> cpu_nodes_;  ///< 按 CPU 编号索引的节点序号
+  size_t node_count_ = 1;          ///< NUMA 节点数量
+};
+
+}  // namespace dispatch
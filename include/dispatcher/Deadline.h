@@ -0,0 +1,40 @@
+/**
+ * @file Deadline.h
+ * @brief 截止时间调度的策略与统计
+ *
+ * 任务可以携带完成截止时间（例如"提交后 20ms 内完成"），与 asyncAfter 指定的开始时间不同。
+ * TaskQueue 按调度策略决定带截止时间的任务的执行顺序，按错过策略处理已经超时的任务，并统计错过的次数。
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace dispatch {
+
+/**
+ * @brief 就绪任务的调度策略
+ */
+enum class SchedulingPolicy : uint8_t {
+  Priority,               ///< 按优先级通道调度，带截止时间的任务与其他任务一样在其优先级通道中先入先出（默认）
+  EarliestDeadlineFirst,  ///< 带截止时间的任务按截止时间从早到晚先于各优先级通道执行（EDF）
+};
+
+/**
+ * @brief 任务开始执行时已经超过截止时间的处理方式
+ */
+enum class DeadlineMissPolicy : uint8_t {
+  Run,   ///< 照常执行，任务内可以通过 TaskQueue::currentTaskMissedDeadline() 得知已超时（默认）
+  Drop,  ///< 丢弃，不再执行（任务函数被销毁，加入调度组的任务离开组）
+};
+
+/**
+ * @brief 带截止时间的任务的统计信息（自队列创建起累计）
+ */
+struct DeadlineStats {
+  uint64_t completed = 0;  ///< 执行完毕的任务数（包括超时完成的任务）
+  uint64_t missed = 0;     ///< 完成时已超过截止时间的任务数
+  uint64_t dropped = 0;    ///< 开始执行前已超过截止时间而被丢弃的任务数
+};
+
+}  // namespace dispatch
@@ -0,0 +1,108 @@
+/**
+ * @file DispatchGroup.h
+ * @brief 调度组
+ *
+ * 跟踪一组任务的完成情况：任务进入组时计数加一，离开时减一，
+ * 计数归零时唤醒 wait() 并投递 notify() 注册的后续任务。
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "Types.h"
+
+namespace dispatch {
+
+class IDispatchQueue;
+
+/**
+ * @brief 调度组
+ *
+ * 用于等待"这一批异步任务"完成，而不必像 sync() 那样等待队列中的所有任务：
+ * - enter()/leave() 手动维护未完成的任务数
+ * - IDispatchQueue::async(group, ...) / asyncAfter(group, ...) 提交的任务自动进入组，
+ *   任务执行完毕并销毁（或被取消、随队列销毁而丢弃）时离开组
+ * - wait() 阻塞调用线程直到计数归零，可以指定超时
+ * - notify() 注册后续任务，计数归零时投递到指定队列，不占用任何线程等待
+ *
+ * 计数是单个原子变量，enter()/leave() 只有一次原子操作；
+ * 仅在计数归零时加锁，唤醒等待者并取出后续任务。
+ *
+ * DispatchGroup 是轻量的句柄，拷贝后指向同一个组，任务捕获句柄即可保证组的生命周期。
+ * 计数归零后可以再次 enter() 复用；归零之前注册的 notify() 只在本轮归零时投递一次。
+ *
+ * 使用示例：
+ * @code
+ * DispatchGroup group;
+ * for (auto& item : items) {
+ *   pool->async(group, [&item]() { process(item); });
+ * }
+ * group.notify(mainQueue, []() { std::cout << "all done" << std::endl; });
+ * group.wait();
+ * @endcode
+ */
+class DispatchGroup {
+ public:
+  DispatchGroup();
+
+  /**
+   * @brief 进入组（未完成计数加一）
+   */
+  void enter() const;
+
+  /**
+   * @brief 离开组（未完成计数减一）
+   *
+   * 计数归零时唤醒所有 wait()，并将 notify() 注册的后续任务投递到各自的队列。
+   * 每次 leave() 必须对应一次 enter()。
+   */
+  void leave() const;
+
+  /**
+   * @brief 阻塞等待组内任务全部完成
+   */
+  void wait() const;
+
+  /**
+   * @brief 阻塞等待组内任务全部完成，最多等待 timeout
+   * @param timeout 最长等待时间
+   * @return true 计数已归零，false 超时
+   */
+  bool wait(std::chrono::steady_clock::duration timeout) const;
+
+  /**
+   * @brief 注册计数归零时执行的后续任务
+   *
+   * 计数已经为零时立即投递。后续任务通过 queue->async() 执行，期间持有队列的引用。
+   *
+   * @param queue 执行后续任务的队列
+   * @param function 后续任务（将被移动）
+   */
+  void notify(const std::shared_ptr<IDispatchQueue>& queue, TaskFunction function) const;
+
+  /**
+   * @brief 获取当前未完成的任务数
+   */
+  int64_t pendingCount() const;
+
+  /**
+   * @brief 将任务包装为组内任务
+   *
+   * 立即进入组，返回的任务在执行完毕并销毁（或未执行即被销毁）时离开组。
+   * 供 IDispatchQueue::async(group, ...) 等接口使用，也可以直接传给其他接受 TaskFunction 的地方。
+   *
+   * @param function 要包装的任务（将被移动）
+   * @return TaskFunction 包装后的任务
+   */
+  TaskFunction track(TaskFunction function) const;
+
+ private:
+  struct State;
+
+  std::shared_ptr<State> state_;  ///< 组的共享状态
+};
+
+}  // namespace dispatch
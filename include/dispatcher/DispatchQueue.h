@@ -13,26 +13,15 @@
 #include <string>
 #include <thread>
 
+#include "Backpressure.h"
+#include "Deadline.h"
 #include "IDispatchQueue.h"
 #include "IQueueListener.h"
+#include "ThreadQoS.h"
 #include "Types.h"
 
 namespace dispatch {
 
-/**
- * @brief 线程服务质量等级
- *
- * 用于指定队列工作线程的优先级。
- * 注意：实际效果取决于操作系统支持。
- */
-enum ThreadQoSClass : uint8_t {
-  kThreadQoSClassLowest = 0,  ///< 最低优先级，适用于后台任务
-  kThreadQoSClassLow = 1,     ///< 低优先级，适用于不紧急的任务
-  kThreadQoSClassNormal = 2,  ///< 普通优先级，默认选择
-  kThreadQoSClassHigh = 3,    ///< 高优先级，适用于用户交互相关任务
-  kThreadQoSClassMax = 4      ///< 最高优先级，适用于实时任务
-};
-
 /**
  * @brief 调度队列基类
  *
@@ -71,6 +60,9 @@ class DispatchQueue : public IDispatchQueue {
   /// 空任务ID常量
   static constexpr TaskId kNullTaskId = 0;
 
+  /// 串行队列每次占用目标队列线程时默认最多执行的任务数
+  static constexpr size_t kDefaultSerialBatchSize = 16;
+
   explicit DispatchQueue();
   DispatchQueue(const DispatchQueue& other) = delete;
   ~DispatchQueue() override;
@@ -85,7 +77,7 @@ class DispatchQueue : public IDispatchQueue {
    * @param function 要执行的函数
    * @return true 执行成功
    */
-  bool safeSync(const DispatchFunction& function);
+  bool safeSync(const TaskFunction& function);
 
   /**
    * @brief 检查当前线程是否是队列的工作线程
@@ -120,6 +112,9 @@ class DispatchQueue : public IDispatchQueue {
 
   /**
    * @brief 设置线程服务质量等级
+   *
+   * 拥有工作线程的队列把等级应用到这些线程的调度策略上（见 ThreadQoS），
+   * 复用其他队列线程的队列忽略此设置。
    * @param qosClass 服务质量等级
    */
   virtual void setQoSClass(ThreadQoSClass qosClass);
@@ -133,6 +128,20 @@ class DispatchQueue : public IDispatchQueue {
    */
   static std::shared_ptr<DispatchQueue> create(const std::string& name, ThreadQoSClass qosClass);
 
+  /**
+   * @brief 创建复用目标队列线程的串行队列（工厂方法）
+   *
+   * 队列不拥有线程，任务在 target（通常是线程池）的线程上按 FIFO 顺序串行执行，
+   * 每次占用线程最多执行 maxBatchSize 个任务后让出。适合大量逻辑上串行的队列共享少量线程。
+   *
+   * @param name 队列名称（用于调试）
+   * @param target 执行任务的目标队列
+   * @param maxBatchSize 每次占用目标队列线程时最多执行的任务数
+   * @return std::shared_ptr<DispatchQueue> 队列实例（SerialDispatchQueue）
+   */
+  static std::shared_ptr<DispatchQueue> create(const std::string& name, const std::shared_ptr<IDispatchQueue>& target,
+                                               size_t maxBatchSize = kDefaultSerialBatchSize);
+
   /**
    * @brief 创建线程化的调度队列
    *
@@ -146,6 +155,9 @@ class DispatchQueue : public IDispatchQueue {
 
   /**
    * @brief 获取当前线程所属的调度队列
+   *
+   * 正在执行串行队列（SerialDispatchQueue）的任务时返回该串行队列。
+   *
    * @return DispatchQueue* 当前队列，如果不在任何队列中则返回 nullptr
    */
   static DispatchQueue* getCurrent();
@@ -177,6 +189,56 @@ class DispatchQueue : public IDispatchQueue {
    */
   virtual void setDisableSyncCallsInCallingThread(bool disableSyncCallsInCallingThread);
 
+  /**
+   * @brief 设置工作线程的空闲超时
+   *
+   * 拥有专属线程的队列在空闲超过 idleTimeout 后释放线程，下一个任务入队时重新创建。
+   * 零表示不释放。没有专属线程的队列忽略此设置。
+   *
+   * @param idleTimeout 空闲超时
+   */
+  virtual void setIdleTimeout(std::chrono::steady_clock::duration idleTimeout);
+
+  /**
+   * @brief 设置就绪任务的调度策略
+   *
+   * EarliestDeadlineFirst 下 asyncWithDeadline() 提交的任务按截止时间先于其他任务执行。
+   * 只影响之后就绪的任务。
+   *
+   * @param policy 调度策略
+   */
+  virtual void setSchedulingPolicy(SchedulingPolicy policy);
+
+  /**
+   * @brief 设置开始执行时已超过截止时间的任务的处理方式（照常执行或丢弃）
+   * @param policy 错过截止时间的处理方式
+   */
+  virtual void setDeadlineMissPolicy(DeadlineMissPolicy policy);
+
+  /**
+   * @brief 获取本队列中带截止时间的任务的统计信息（完成、错过、丢弃的数量）
+   * @return DeadlineStats 统计信息，不支持截止时间的队列返回全零
+   */
+  virtual DeadlineStats deadlineStats() const;
+
+  /**
+   * @brief 设置队列容量和溢出策略
+   *
+   * 容量是等待执行的任务数上限（包括尚未到期的延迟任务，不包括正在执行的任务）。队列已满时
+   * async/asyncAfter/asyncBatch 等按 policy 阻塞调用线程或丢弃任务，tryAsync 返回 false。
+   * 本队列的工作线程向本队列提交时不受限制（避免等待自己）。
+   *
+   * @param capacity 容量，0 表示不限制（默认）
+   * @param policy 溢出策略
+   */
+  virtual void setCapacity(size_t capacity, OverflowPolicy policy = OverflowPolicy::Block);
+
+  /**
+   * @brief 获取有界队列的统计信息（阻塞、拒绝、丢弃的次数）
+   * @return OverflowStats 统计信息，不支持容量的队列返回全零
+   */
+  virtual OverflowStats overflowStats() const;
+
  protected:
   bool runningSync_ = false;  ///< 是否正在执行同步任务
 
@@ -0,0 +1,522 @@
+/**
+ * @file Future.h
+ * @brief 轻量的 Future/Promise 与非阻塞续延
+ *
+ * asyncValue() 在队列上执行有返回值的任务并返回 Future；
+ * Future::then() 在结果就绪后把续延任务投递到指定队列，whenAll()/whenAny() 组合多个 Future。
+ * 整个结果流水线不需要任何线程阻塞在 get() 上。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ClosureAllocator.h"
+#include "IDispatchQueue.h"
+#include "Types.h"
+
+namespace dispatch {
+
+template <typename T>
+class Future;
+template <typename T>
+class Promise;
+
+namespace detail {
+
+/// void 结果的占位类型
+struct FutureUnit {};
+
+/**
+ * @brief Future 与 Promise 共享的状态
+ *
+ * 由 std::make_shared 一次分配，结果与控制块在同一块内存中。
+ * 状态转换全部是原子操作，不使用互斥锁：
+ * - claimed_：第一个 setValue()/setException() 通过 exchange 获得写入权，其余调用返回 false
+ * - callbacks_：续延回调的无锁栈；写入结果后交换为就绪标记并执行已注册的回调，
+ *   之后注册的回调直接在注册线程执行
+ */
+template <typename T>
+class FutureState {
+ public:
+  using Storage = std::conditional_t<std::is_void<T>::value, FutureUnit, T>;
+
+  FutureState() = default;
+  FutureState(const FutureState&) = delete;
+  FutureState& operator=(const FutureState&) = delete;
+
+  ~FutureState() {
+    // 未完成就被销毁时丢弃尚未执行的回调
+    auto* head = callbacks_.load(std::memory_order_acquire);
+    while (head != nullptr && head != readyMarker()) {
+      auto* next = head->next;
+      releaseCallback(head);
+      head = next;
+    }
+    if (has_value_) {
+      value().~Storage();
+    }
+  }
+
+  /// 写入结果，已有结果时返回 false
+  template <typename... Args>
+  bool setValue(Args&&... args) {
+    if (claimed_.exchange(true, std::memory_order_acq_rel)) {
+      return false;
+    }
+    ::new (static_cast<void*>(&storage_)) Storage(std::forward<Args>(args)...);
+    has_value_ = true;
+    publish();
+    return true;
+  }
+
+  /// 写入异常，已有结果时返回 false
+  bool setException(std::exception_ptr exception) {
+    if (claimed_.exchange(true, std::memory_order_acq_rel)) {
+      return false;
+    }
+    exception_ = std::move(exception);
+    publish();
+    return true;
+  }
+
+  /// 是否已经有线程开始写入结果
+  bool isSatisfied() const { return claimed_.load(std::memory_order_acquire); }
+
+  /// 结果是否已经可读
+  bool isReady() const { return callbacks_.load(std::memory_order_acquire) == readyMarker(); }
+
+  /// 就绪后访问结果（调用方需先确认 isReady()）
+  const Storage& value() const { return *std::launder(reinterpret_cast<const Storage*>(&storage_)); }
+  Storage& value() { return *std::launder(reinterpret_cast<Storage*>(&storage_)); }
+  const std::exception_ptr& exception() const { return exception_; }
+
+  /**
+   * @brief 注册就绪回调
+   *
+   * 尚未就绪时压入回调栈，由写入结果的线程按注册顺序执行；已经就绪时在当前线程立即执行。
+   */
+  void addCallback(TaskFunction function) {
+    auto* head = callbacks_.load(std::memory_order_acquire);
+    if (head != readyMarker()) {
+      auto* node = ::new (ClosureAllocator::allocate(sizeof(Callback))) Callback{head, std::move(function)};
+      while (head != readyMarker()) {
+        node->next = head;
+        if (callbacks_.compare_exchange_weak(head, node, std::memory_order_acq_rel, std::memory_order_acquire)) {
+          return;
+        }
+      }
+      function = std::move(node->function);
+      releaseCallback(node);
+    }
+    function();
+  }
+
+  /// 阻塞等待结果就绪，直到 deadline；只有真正需要阻塞时才分配等待对象
+  bool waitUntil(std::chrono::steady_clock::time_point deadline, bool forever) {
+    if (isReady()) {
+      return true;
+    }
+
+    struct Waiter {
+      std::mutex mutex;
+      std::condition_variable condition;
+      bool ready = false;
+    };
+    auto waiter = std::make_shared<Waiter>();
+    addCallback([waiter]() {
+      std::lock_guard<std::mutex> lock(waiter->mutex);
+      waiter->ready = true;
+      waiter->condition.notify_all();
+    });
+
+    std::unique_lock<std::mutex> lock(waiter->mutex);
+    if (forever) {
+      waiter->condition.wait(lock, [&waiter]() { return waiter->ready; });
+      return true;
+    }
+    return waiter->condition.wait_until(lock, deadline, [&waiter]() { return waiter->ready; });
+  }
+
+ private:
+  /// 回调栈节点，从 ClosureAllocator 分配
+  struct Callback {
+    Callback* next;
+    TaskFunction function;
+  };
+
+  static Callback* readyMarker() {
+    static Callback marker{nullptr, TaskFunction()};
+    return &marker;
+  }
+
+  static void releaseCallback(Callback* node) {
+    node->~Callback();
+    ClosureAllocator::deallocate(node, sizeof(Callback));
+  }
+
+  /// 发布结果并按注册顺序执行已注册的回调
+  void publish() {
+    auto* head = callbacks_.exchange(readyMarker(), std::memory_order_acq_rel);
+    Callback* ordered = nullptr;
+    while (head != nullptr) {
+      auto* next = head->next;
+      head->next = ordered;
+      ordered = head;
+      head = next;
+    }
+    while (ordered != nullptr) {
+      auto* next = ordered->next;
+      ordered->function();
+      releaseCallback(ordered);
+      ordered = next;
+    }
+  }
+
+  std::atomic<bool> claimed_{false};                         ///< 是否已有线程获得写入权
+  std::atomic<Callback*> callbacks_{nullptr};                ///< 回调栈，就绪后为 readyMarker()
+  bool has_value_ = false;                                   ///< storage_ 中是否有值
+  std::exception_ptr exception_;                             ///< 任务抛出的异常
+  alignas(Storage) unsigned char storage_[sizeof(Storage)];  ///< 结果的存储空间
+};
+
+/// 以 const T& 为参数（T 为 void 时无参数）调用续延 F 的返回类型
+template <typename T, typename F>
+struct ContinuationResult {
+  using type = std::invoke_result_t<F&, const T&>;
+};
+
+template <typename F>
+struct ContinuationResult<void, F> {
+  using type = std::invoke_result_t<F&>;
+};
+
+/// whenAll() 的结果类型：按输入顺序排列的结果，T 为 void 时没有结果
+template <typename T>
+struct WhenAllResult {
+  using type = std::vector<T>;
+};
+
+template <>
+struct WhenAllResult<void> {
+  using type = void;
+};
+
+/// 执行 produce 并把结果或异常写入 promise
+template <typename R, typename F>
+void fulfill(Promise<R>& promise, F&& produce) {
+  try {
+    if constexpr (std::is_void<R>::value) {
+      produce();
+      promise.setValue();
+    } else {
+      promise.setValue(produce());
+    }
+  } catch (...) {
+    promise.setException(std::current_exception());
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief 异步结果
+ *
+ * 与 std::shared_future 类似，可以拷贝，所有副本共享同一个结果；
+ * 与 std::future 的区别：
+ * - 共享状态只有一次分配，完成与注册续延都是原子操作，没有互斥锁和条件变量
+ * - then() 在结果就绪后把续延投递到指定队列，不阻塞任何线程
+ * - 只有 get()/wait() 需要阻塞时才分配等待对象
+ *
+ * 使用示例：
+ * @code
+ * auto size = asyncValue(ioQueue, []() { return loadFile("data.bin"); })
+ *                 .then(pool, [](const std::string& data) { return parse(data); })
+ *                 .then(mainQueue, [](const Model& model) { return model.size(); });
+ * size.get();
+ * @endcode
+ *
+ * @tparam T 结果类型，可以是 void
+ */
+template <typename T>
+class Future {
+ public:
+  Future() = default;
+
+  /**
+   * @brief 是否关联了共享状态（默认构造的 Future 无效）
+   */
+  bool valid() const { return state_ != nullptr; }
+
+  /**
+   * @brief 结果（或异常）是否已经就绪
+   */
+  bool isReady() const { return state_->isReady(); }
+
+  /**
+   * @brief 阻塞等待结果就绪
+   */
+  void wait() const { state_->waitUntil(std::chrono::steady_clock::time_point(), true); }
+
+  /**
+   * @brief 阻塞等待结果就绪，最多等待 timeout
+   * @param timeout 最长等待时间
+   * @return true 结果已就绪，false 超时
+   */
+  bool wait(std::chrono::steady_clock::duration timeout) const {
+    return state_->waitUntil(std::chrono::steady_clock::now() + timeout, false);
+  }
+
+  /**
+   * @brief 等待并获取结果
+   * @return 结果的常量引用（void 时无返回值）
+   * @throw 任务抛出的异常；Promise 未设置结果即被销毁时为 std::future_error(broken_promise)
+   */
+  decltype(auto) get() const {
+    wait();
+    if (state_->exception()) {
+      std::rethrow_exception(state_->exception());
+    }
+    if constexpr (!std::is_void<T>::value) {
+      // 所有副本共享同一个结果，通过常量引用访问，避免任何一个副本修改它
+      return static_cast<const detail::FutureState<T>&>(*state_).value();
+    }
+  }
+
+  /**
+   * @brief 结果就绪后在指定队列上执行续延
+   *
+   * 续延以结果的常量引用为参数（T 为 void 时无参数），其返回值成为新 Future 的结果。
+   * 本 Future 以异常结束时不调用续延，异常直接传递给新 Future。
+   * 续延任务未执行就被丢弃（例如队列已销毁）时，新 Future 以 broken_promise 结束。
+   *
+   * @param queue 执行续延的队列（续延完成前持有其引用）
+   * @param function 续延函数
+   * @return Future 续延的结果
+   */
+  template <typename F>
+  auto then(const std::shared_ptr<IDispatchQueue>& queue, F&& function) const
+      -> Future<typename detail::ContinuationResult<T, std::decay_t<F>>::type>;
+
+  /**
+   * @brief 结果就绪后在完成的线程上直接执行回调
+   *
+   * 回调在写入结果的线程上内联执行（已就绪时在调用线程立即执行），
+   * 只适合很轻的操作，例如计数或把任务转交给其他队列。whenAll()/whenAny() 基于此实现。
+   *
+   * @param callback 回调函数
+   */
+  void onReady(TaskFunction callback) const { state_->addCallback(std::move(callback)); }
+
+ private:
+  friend class Promise<T>;
+
+  explicit Future(std::shared_ptr<detail::FutureState<T>> state) : state_(std::move(state)) {}
+
+  std::shared_ptr<detail::FutureState<T>> state_;  ///< 共享状态
+};
+
+/**
+ * @brief 结果的写入端
+ *
+ * 仅可移动。未写入结果就被销毁时，关联的 Future 以 std::future_error(broken_promise) 结束，
+ * 因此续延链不会因为任务被取消或队列被销毁而永远挂起。
+ *
+ * @tparam T 结果类型，可以是 void
+ */
+template <typename T>
+class Promise {
+ public:
+  Promise() : state_(std::make_shared<detail::FutureState<T>>()) {}
+  Promise(Promise&& other) noexcept = default;
+  Promise& operator=(Promise&& other) noexcept {
+    if (this != &other) {
+      abandon();
+      state_ = std::move(other.state_);
+    }
+    return *this;
+  }
+  Promise(const Promise&) = delete;
+  Promise& operator=(const Promise&) = delete;
+  ~Promise() { abandon(); }
+
+  /**
+   * @brief 获取关联的 Future（可以多次调用，得到的 Future 共享同一个结果）
+   */
+  Future<T> future() const { return Future<T>(state_); }
+
+  /**
+   * @brief 写入结果并执行已注册的回调
+   * @param args 构造结果的参数（T 为 void 时不传参数）
+   * @return true 写入成功，false 已经写入过结果
+   */
+  template <typename... Args>
+  bool setValue(Args&&... args) {
+    return state_->setValue(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief 写入异常并执行已注册的回调
+   * @param exception 异常
+   * @return true 写入成功，false 已经写入过结果
+   */
+  bool setException(std::exception_ptr exception) { return state_->setException(std::move(exception)); }
+
+ private:
+  void abandon() {
+    if (state_ != nullptr && !state_->isSatisfied()) {
+      state_->setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+    }
+  }
+
+  std::shared_ptr<detail::FutureState<T>> state_;  ///< 共享状态
+};
+
+template <typename T>
+template <typename F>
+auto Future<T>::then(const std::shared_ptr<IDispatchQueue>& queue, F&& function) const
+    -> Future<typename detail::ContinuationResult<T, std::decay_t<F>>::type> {
+  using R = typename detail::ContinuationResult<T, std::decay_t<F>>::type;
+  Promise<R> promise;
+  auto result = promise.future();
+
+  // 就绪回调只负责投递任务，续延本身在目标队列上执行
+  state_->addCallback([state = state_, queue, promise = std::move(promise),
+                       function = std::forward<F>(function)]() mutable {
+    queue->async([state = std::move(state), promise = std::move(promise), function = std::move(function)]() mutable {
+      if (state->exception()) {
+        promise.setException(state->exception());
+        return;
+      }
+      if constexpr (std::is_void<T>::value) {
+        detail::fulfill(promise, function);
+      } else {
+        const auto& value = static_cast<const detail::FutureState<T>&>(*state).value();
+        detail::fulfill(promise, [&]() -> R { return function(value); });
+      }
+    });
+  });
+  return result;
+}
+
+/**
+ * @brief 在队列上执行有返回值的任务
+ *
+ * 任务的返回值（或抛出的异常）写入返回的 Future。
+ * 任务被取消或随队列销毁而丢弃时，Future 以 std::future_error(broken_promise) 结束。
+ *
+ * @param queue 执行任务的队列
+ * @param function 任务函数
+ * @return Future 任务的结果
+ */
+template <typename F>
+auto asyncValue(const std::shared_ptr<IDispatchQueue>& queue, F&& function)
+    -> Future<std::invoke_result_t<std::decay_t<F>&>> {
+  using R = std::invoke_result_t<std::decay_t<F>&>;
+  Promise<R> promise;
+  auto result = promise.future();
+  queue->async([promise = std::move(promise), function = std::forward<F>(function)]() mutable {
+    detail::fulfill(promise, function);
+  });
+  return result;
+}
+
+/**
+ * @brief 等待一组 Future 全部就绪
+ *
+ * 所有 Future 就绪后，新 Future 按输入顺序得到全部结果（T 为 void 时没有结果）；
+ * 任一 Future 以异常结束时，新 Future 以输入顺序中第一个异常结束。
+ * 完成检测在最后一个就绪的线程上完成，不占用队列线程。
+ *
+ * @param futures 要等待的 Future
+ * @return Future 全部结果
+ */
+template <typename T>
+Future<typename detail::WhenAllResult<T>::type> whenAll(const std::vector<Future<T>>& futures) {
+  using R = typename detail::WhenAllResult<T>::type;
+
+  struct Aggregate {
+    std::vector<Future<T>> futures;
+    std::atomic<size_t> remaining;
+    Promise<R> promise;
+
+    void complete() {
+      for (const auto& future : futures) {
+        // 已就绪的 Future 上 get() 不会阻塞，异常直接转交
+        try {
+          future.get();
+        } catch (...) {
+          promise.setException(std::current_exception());
+          return;
+        }
+      }
+      detail::fulfill(promise, [this]() -> R {
+        if constexpr (!std::is_void<T>::value) {
+          R values;
+          values.reserve(futures.size());
+          for (const auto& future : futures) {
+            values.push_back(future.get());
+          }
+          return values;
+        }
+      });
+    }
+  };
+
+  auto aggregate = std::make_shared<Aggregate>();
+  aggregate->futures = futures;
+  aggregate->remaining.store(futures.size(), std::memory_order_relaxed);
+  auto result = aggregate->promise.future();
+
+  if (futures.empty()) {
+    aggregate->complete();
+    return result;
+  }
+  for (const auto& future : futures) {
+    future.onReady([aggregate]() {
+      if (aggregate->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        aggregate->complete();
+      }
+    });
+  }
+  return result;
+}
+
+/**
+ * @brief 等待一组 Future 中任意一个就绪
+ *
+ * 新 Future 的结果是第一个就绪（包括以异常结束）的 Future 在输入中的下标，
+ * 调用方可以随后对该 Future 调用 get()，不会阻塞。
+ *
+ * @param futures 要等待的 Future
+ * @return Future<size_t> 第一个就绪的下标；futures 为空时以 std::invalid_argument 结束
+ */
+template <typename T>
+Future<size_t> whenAny(const std::vector<Future<T>>& futures) {
+  auto promise = std::make_shared<Promise<size_t>>();
+  auto result = promise->future();
+
+  if (futures.empty()) {
+    promise->setException(std::make_exception_ptr(std::invalid_argument("whenAny() requires at least one future")));
+    return result;
+  }
+  for (size_t i = 0; i < futures.size(); ++i) {
+    // 只有第一个就绪的 Future 能写入结果，其余的 setValue() 返回 false
+    futures[i].onReady([promise, i]() { promise->setValue(i); });
+  }
+  return result;
+}
+
+}  // namespace dispatch
@@ -10,11 +10,20 @@
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include "DispatchGroup.h"
+#include "ThreadQoS.h"
 #include "Types.h"
 
 namespace dispatch {
 
+#ifdef DISPATCHER_COROUTINES
+class ScheduleAwaiter;
+class AfterAwaiter;
+#endif
+
 /**
  * @brief 调度队列接口
  *
@@ -22,7 +31,12 @@ namespace dispatch {
  * - 同步执行：阻塞等待任务完成
  * - 异步执行：立即返回，任务在后台执行
  * - 延迟执行：指定延迟后执行任务
+ * - 批量执行：一次提交一组任务
  * - 取消任务：通过任务ID取消尚未执行的任务
+ * - 调度组：async/asyncAfter 可以将任务加入 DispatchGroup，等待一批任务完成
+ * - 任务优先级：async/asyncAfter 可以指定优先级，高优先级的任务先于已排队的低优先级任务执行
+ * - 截止时间：asyncWithDeadline 提交需要在指定时间内完成的任务
+ * - 背压：tryAsync 在有界队列已满时立即返回 false，可以登记腾出空间时的回调
  *
  * 继承自 enable_shared_from_this 以支持安全的自引用。
  */
@@ -39,7 +53,7 @@ class IDispatchQueue : public std::enable_shared_from_this<IDispatchQueue> {
    * @param function 要执行的任务函数
    * @warning 不要在队列的工作线程中调用 sync，会导致死锁
    */
-  virtual void sync(const DispatchFunction& function) = 0;
+  virtual void sync(const TaskFunction& function) = 0;
 
   /**
    * @brief 异步执行任务
@@ -48,7 +62,7 @@ class IDispatchQueue : public std::enable_shared_from_this<IDispatchQueue> {
    *
    * @param function 要执行的任务函数（将被移动）
    */
-  virtual void async(DispatchFunction function) = 0;
+  virtual void async(TaskFunction function) = 0;
 
   /**
    * @brief 延迟异步执行任务
@@ -59,7 +73,174 @@ class IDispatchQueue : public std::enable_shared_from_this<IDispatchQueue> {
    * @param delay 延迟时间
    * @return TaskId 任务ID，可用于取消任务
    */
-  virtual TaskId asyncAfter(DispatchFunction function, std::chrono::steady_clock::duration delay) = 0;
+  virtual TaskId asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay) = 0;
+
+  /**
+   * @brief 异步执行任务并加入调度组
+   *
+   * 任务提交前进入组，执行完毕后离开组；任务未执行即被丢弃时同样离开组。
+   * 派生类重写 async 时需要 using IDispatchQueue::async 以保留此重载。
+   *
+   * @param group 调度组
+   * @param function 要执行的任务函数（将被移动）
+   */
+  void async(const DispatchGroup& group, TaskFunction function) { async(group.track(std::move(function))); }
+
+  /**
+   * @brief 延迟异步执行任务并加入调度组
+   *
+   * 任务提交时即进入组，因此组在延迟期间不会归零；任务被 cancel() 取消时离开组。
+   *
+   * @param group 调度组
+   * @param function 要执行的任务函数（将被移动）
+   * @param delay 延迟时间
+   * @return TaskId 任务ID，可用于取消任务
+   */
+  TaskId asyncAfter(const DispatchGroup& group, TaskFunction function, std::chrono::steady_clock::duration delay) {
+    return asyncAfter(group.track(std::move(function)), delay);
+  }
+
+  /**
+   * @brief 按优先级异步执行任务
+   *
+   * 基于 TaskQueue 的队列按优先级通道调度（高优先级先执行，低优先级通过老化避免饥饿）；
+   * 默认实现忽略优先级。kThreadQoSClassNormal 与 async(function) 相同。
+   *
+   * @param function 要执行的任务函数（将被移动）
+   * @param priority 任务优先级
+   */
+  virtual void async(TaskFunction function, ThreadQoSClass priority) {
+    (void)priority;
+    async(std::move(function));
+  }
+
+  /**
+   * @brief 按优先级延迟异步执行任务
+   *
+   * 任务到期后进入其优先级通道。默认实现忽略优先级。
+   *
+   * @param function 要执行的任务函数（将被移动）
+   * @param delay 延迟时间
+   * @param priority 任务优先级
+   * @return TaskId 任务ID，可用于取消任务
+   */
+  virtual TaskId asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay,
+                            ThreadQoSClass priority) {
+    (void)priority;
+    return asyncAfter(std::move(function), delay);
+  }
+
+  /**
+   * @brief 按优先级异步执行任务并加入调度组
+   * @param group 调度组
+   * @param function 要执行的任务函数（将被移动）
+   * @param priority 任务优先级
+   */
+  void async(const DispatchGroup& group, TaskFunction function, ThreadQoSClass priority) {
+    async(group.track(std::move(function)), priority);
+  }
+
+  /**
+   * @brief 异步执行需要在截止时间前完成的任务
+   *
+   * 截止时间从提交时开始计算，与 asyncAfter 的延迟（开始时间）不同。基于 TaskQueue 的队列在
+   * SchedulingPolicy::EarliestDeadlineFirst 下按截止时间排序，并统计错过截止时间的任务
+   * （见 DispatchQueue::setSchedulingPolicy）；默认实现忽略截止时间。
+   *
+   * @param function 要执行的任务函数（将被移动）
+   * @param deadline 从现在起的完成期限
+   */
+  virtual void asyncWithDeadline(TaskFunction function, std::chrono::steady_clock::duration deadline) {
+    (void)deadline;
+    async(std::move(function));
+  }
+
+  /**
+   * @brief 异步执行需要在截止时间前完成的任务并加入调度组
+   *
+   * 任务因超时被丢弃时同样离开组。
+   *
+   * @param group 调度组
+   * @param function 要执行的任务函数（将被移动）
+   * @param deadline 从现在起的完成期限
+   */
+  void asyncWithDeadline(const DispatchGroup& group, TaskFunction function,
+                         std::chrono::steady_clock::duration deadline) {
+    asyncWithDeadline(group.track(std::move(function)), deadline);
+  }
+
+  /**
+   * @brief 尝试异步执行任务，队列已满时立即返回 false
+   *
+   * 有界队列（见 DispatchQueue::setCapacity）已满时既不阻塞也不丢弃任务。默认实现与 async 相同，总是返回 true。
+   *
+   * @param function 要执行的任务函数，返回 false 时保持不变，可以稍后重试
+   * @return true 已提交
+   * @return false 队列已满或已销毁
+   */
+  virtual bool tryAsync(TaskFunction&& function) {
+    async(std::move(function));
+    return true;
+  }
+
+  /**
+   * @brief 尝试异步执行任务，队列已满时登记腾出空间时的回调
+   *
+   * 返回 false 时保存 onSpaceAvailable，队列腾出空间时在腾出空间的线程上调用一次，调用者通常在回调中重试，
+   * 生产者不需要占用线程等待。默认实现与 async 相同，总是返回 true。
+   *
+   * @param function 要执行的任务函数，返回 false 时保持不变，可以稍后重试
+   * @param onSpaceAvailable 腾出空间时的回调（应尽量简短）
+   * @return true 已提交
+   * @return false 队列已满或已销毁（已销毁时不保存回调）
+   */
+  virtual bool tryAsync(TaskFunction&& function, TaskFunction onSpaceAvailable) {
+    (void)onSpaceAvailable;
+    async(std::move(function));
+    return true;
+  }
+
+  /**
+   * @brief 批量异步执行任务
+   *
+   * 一次提交一组任务，执行顺序与数组顺序一致。
+   * 相比逐个调用 async，只获取一次锁、只唤醒一次工作线程。
+   *
+   * @param functions 要执行的任务函数（将被移动）
+   */
+  virtual void asyncBatch(std::vector<TaskFunction> functions) = 0;
+
+  /**
+   * @brief 批量延迟异步执行任务
+   *
+   * 一组任务共享同一个执行时间，到期后按数组顺序执行。
+   *
+   * @param functions 要执行的任务函数（将被移动）
+   * @param delay 延迟时间
+   * @return TaskId 第一个任务的ID，其余任务的ID依次加一；functions 为空时返回 0
+   */
+  virtual TaskId asyncBatchAfter(std::vector<TaskFunction> functions, std::chrono::steady_clock::duration delay) = 0;
+
+#ifdef DISPATCHER_COROUTINES
+  /**
+   * @brief 协程切换到本队列执行：co_await queue->schedule()
+   *
+   * 需要 C++20 协程支持，定义见 Coroutine.h。
+   *
+   * @return ScheduleAwaiter 等待器
+   */
+  ScheduleAwaiter schedule();
+
+  /**
+   * @brief 协程延迟后在本队列恢复执行：co_await queue->after(delay)
+   *
+   * 需要 C++20 协程支持，定义见 Coroutine.h。
+   *
+   * @param delay 延迟时间
+   * @return AfterAwaiter 等待器
+   */
+  AfterAwaiter after(std::chrono::steady_clock::duration delay);
+#endif
 
   /**
    * @brief 取消任务
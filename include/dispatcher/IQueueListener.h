@@ -22,6 +22,9 @@ namespace dispatch {
  * - 显示/隐藏加载指示器
  * - 触发空闲时的清理操作
  * - 性能监控和日志记录
+ *
+ * 回调不在队列内部锁中执行，可以在回调中提交任务或查询队列；
+ * 同一队列的回调不会并发执行，并按状态变化的顺序调用。
  */
 class IQueueListener {
  public:
@@ -31,7 +34,7 @@ class IQueueListener {
    * @brief 当队列变空时调用
    *
    * 所有任务执行完毕，队列进入空闲状态时触发。
-   * 注意：此回调在队列的工作线程中执行。
+   * 注意：此回调通常在队列的工作线程中执行。
    */
   virtual void onQueueEmpty() = 0;
 
@@ -39,7 +42,7 @@ class IQueueListener {
    * @brief 当队列变为非空时调用
    *
    * 有新任务加入到空队列时触发。
-   * 注意：此回调在提交任务的线程中执行。
+   * 注意：此回调通常在提交任务的线程中执行；若其他线程正在投递回调，则由该线程依次调用。
    */
   virtual void onQueueNonEmpty() = 0;
 };
@@ -0,0 +1,271 @@
+/**
+ * @file SerialDispatchQueue.h
+ * @brief 复用目标队列线程的串行队列
+ *
+ * 不拥有线程，任务由目标队列（通常是线程池）的线程按 FIFO 顺序串行执行。
+ * 适合大量逻辑上串行的队列（例如每个连接/会话一个队列）共享少量线程。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DispatchQueue.h"
+#include "TaskQueue.h"
+
+namespace dispatch {
+
+/**
+ * @brief 串行调度队列（复用目标队列的线程）
+ *
+ * 特性：
+ * - 任务按提交顺序串行执行，同一时刻最多一个任务在执行
+ * - 不拥有线程：有任务时向目标队列投递一个排空任务，队列为空时不占用任何线程
+ * - 每个排空任务最多执行 maxBatchSize 个任务，之后重新投递到目标队列末尾，
+ *   让出线程给同一目标上的其他队列，避免单个繁忙队列饿死其他队列
+ * - 支持同步/异步/延迟任务、取消和监听器，与 ThreadedDispatchQueue 行为一致
+ *
+ * 工作原理：
+ * 1. 任务进入内部的 TaskQueue（提供顺序、延迟任务和取消）
+ * 2. scheduled_ 从 false 变为 true 的提交者向目标队列投递排空任务，保证同时只有一个排空任务
+ * 3. 延迟任务额外向目标队列投递一个同样延迟的唤醒任务，到期时触发排空
+ * 4. 排空任务和唤醒任务不受目标队列容量的限制；排空任务未执行就被丢弃时（例如有界目标队列的
+ *    DropOldest）清除 scheduled_ 并重新投递
+ *
+ * 目标队列的生命周期由本队列持有；目标队列被销毁后，本队列的任务不再执行。
+ * 必须通过 std::shared_ptr 持有（排空任务通过 weak_ptr 引用本队列）。
+ *
+ * 使用示例：
+ * @code
+ * auto pool = ThreadPoolDispatchQueue::create("IO");
+ * auto session = DispatchQueue::create("Session-42", pool);
+ * session->async([]() { handleRequest(); });  // 与同一会话的其他任务串行执行
+ * @endcode
+ */
+class SerialDispatchQueue : public DispatchQueue {
+ public:
+  /**
+   * @brief 构造函数
+   * @param name 队列名称（用于调试）
+   * @param target 执行任务的目标队列
+   * @param maxBatchSize 每次占用目标队列线程时最多执行的任务数（0 视为 1）
+   */
+  SerialDispatchQueue(const std::string& name, std::shared_ptr<IDispatchQueue> target,
+                      size_t maxBatchSize = kDefaultSerialBatchSize);
+
+  ~SerialDispatchQueue() override;
+
+  /**
+   * @brief 同步执行任务
+   *
+   * 提交任务并阻塞等待其执行完成（在目标队列的线程上执行）。
+   * 在本队列的任务中调用时直接执行。
+   *
+   * @param function 要执行的任务
+   * @warning 不要在目标队列的所有线程上同时调用，会耗尽目标队列的线程导致死锁
+   */
+  void sync(const TaskFunction& function) final;
+
+  // 保留 IDispatchQueue 中接受 DispatchGroup 的重载
+  using IDispatchQueue::async;
+  using IDispatchQueue::asyncAfter;
+  using IDispatchQueue::asyncWithDeadline;
+
+  /**
+   * @brief 异步执行任务
+   * @param function 要执行的任务
+   */
+  void async(TaskFunction function) override;
+
+  /**
+   * @brief 延迟异步执行任务
+   * @param function 要执行的任务
+   * @param delay 延迟时间
+   * @return TaskId 任务ID，可用于取消
+   */
+  TaskId asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay) override;
+
+  /**
+   * @brief 按优先级异步执行任务
+   *
+   * 优先级只决定本队列内部的执行顺序，排空任务在目标队列中使用默认优先级。
+   * @param function 要执行的任务
+   * @param priority 任务优先级
+   */
+  void async(TaskFunction function, ThreadQoSClass priority) override;
+
+  /**
+   * @brief 按优先级延迟异步执行任务
+   * @param function 要执行的任务
+   * @param delay 延迟时间
+   * @param priority 任务优先级
+   * @return TaskId 任务ID，可用于取消
+   */
+  TaskId asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay,
+                    ThreadQoSClass priority) override;
+
+  /**
+   * @brief 异步执行需要在截止时间前完成的任务
+   *
+   * 截止时间只决定本队列内部的执行顺序（EDF 策略下），排空任务在目标队列中没有截止时间。
+   * @param function 要执行的任务
+   * @param deadline 从现在起的完成期限
+   */
+  void asyncWithDeadline(TaskFunction function, std::chrono::steady_clock::duration deadline) override;
+
+  /**
+   * @brief 尝试异步执行任务，队列已满时立即返回 false
+   * @param function 要执行的任务，返回 false 时保持不变
+   * @return true 已提交
+   */
+  bool tryAsync(TaskFunction&& function) override;
+
+  /**
+   * @brief 尝试异步执行任务，队列已满时登记腾出空间时的回调
+   * @param function 要执行的任务，返回 false 时保持不变
+   * @param onSpaceAvailable 腾出空间时的回调（在目标队列的线程上调用）
+   * @return true 已提交
+   */
+  bool tryAsync(TaskFunction&& function, TaskFunction onSpaceAvailable) override;
+
+  /**
+   * @brief 批量异步执行任务
+   * @param functions 要执行的任务
+   */
+  void asyncBatch(std::vector<TaskFunction> functions) override;
+
+  /**
+   * @brief 批量延迟异步执行任务
+   * @param functions 要执行的任务
+   * @param delay 延迟时间
+   * @return TaskId 第一个任务的ID，其余任务的ID依次加一
+   */
+  TaskId asyncBatchAfter(std::vector<TaskFunction> functions, std::chrono::steady_clock::duration delay) override;
+
+  /**
+   * @brief 取消任务
+   * @param taskId 要取消的任务ID
+   */
+  void cancel(TaskId taskId) override;
+
+  /**
+   * @brief 检查当前线程是否正在执行本队列的任务
+   * @return true 当前在本队列的任务中
+   */
+  bool isCurrent() const override;
+
+  /**
+   * @brief 完全销毁队列
+   *
+   * 丢弃尚未执行的任务；正在执行的任务不受影响。
+   */
+  void fullTeardown() override;
+
+  /**
+   * @brief 检查队列是否已销毁
+   * @return true 队列已销毁
+   */
+  bool isDisposed() const;
+
+  /**
+   * @brief 获取目标队列
+   * @return std::shared_ptr<IDispatchQueue> 目标队列
+   */
+  const std::shared_ptr<IDispatchQueue>& target() const { return target_; }
+
+  /**
+   * @brief 设置队列监听器
+   * @param listener 监听器对象
+   */
+  void setListener(const std::shared_ptr<IQueueListener>& listener) override;
+
+  /**
+   * @brief 设置就绪任务的调度策略
+   * @param policy 调度策略
+   */
+  void setSchedulingPolicy(SchedulingPolicy policy) override;
+
+  /**
+   * @brief 设置开始执行时已超过截止时间的任务的处理方式
+   * @param policy 错过截止时间的处理方式
+   */
+  void setDeadlineMissPolicy(DeadlineMissPolicy policy) override;
+
+  /**
+   * @brief 获取带截止时间的任务的统计信息
+   * @return DeadlineStats 统计信息
+   */
+  DeadlineStats deadlineStats() const override;
+
+  /**
+   * @brief 设置队列容量和溢出策略
+   *
+   * 只限制本队列中等待执行的任务，本队列的任务向本队列提交时不受限制。
+   * @param capacity 容量，0 表示不限制
+   * @param policy 溢出策略
+   */
+  void setCapacity(size_t capacity, OverflowPolicy policy = OverflowPolicy::Block) override;
+
+  /**
+   * @brief 获取有界队列的统计信息
+   * @return OverflowStats 统计信息
+   */
+  OverflowStats overflowStats() const override;
+
+  /**
+   * @brief 获取当前线程正在执行的 SerialDispatchQueue
+   * @return SerialDispatchQueue* 当前队列，如果不在任何串行队列的任务中则返回 nullptr
+   */
+  static SerialDispatchQueue* getCurrent();
+
+  // 仅用于测试
+  std::shared_ptr<IQueueListener> getListener() const override;
+
+ private:
+  class DrainTicket;
+
+  std::shared_ptr<TaskQueue> taskQueue_;    ///< 内部任务队列（顺序、延迟任务、取消）
+  std::shared_ptr<IDispatchQueue> target_;  ///< 执行任务的目标队列
+  std::string name_;                        ///< 队列名称
+  size_t maxBatchSize_;                     ///< 每个排空任务最多执行的任务数
+  std::atomic<bool> scheduled_{false};      ///< 是否已有排空任务在目标队列中（或正在执行）
+  std::atomic<bool> timerFired_{false};     ///< 延迟任务的唤醒任务已到期，需要再排空一次
+
+  /**
+   * @brief 确保目标队列中有一个排空任务
+   */
+  void scheduleDrain();
+
+  /**
+   * @brief 向目标队列投递排空任务（调用方已将 scheduled_ 置为 true）
+   * @param yield 是否排到目标队列共享队列的末尾（用完批量配额后让出线程）
+   */
+  void postDrain(bool yield);
+
+  /**
+   * @brief 排空任务未执行就被目标队列丢弃：清除 scheduled_ 并重新投递
+   */
+  void drainDropped();
+
+  /**
+   * @brief 延迟任务到期时的唤醒：标记后确保有排空任务
+   */
+  void timerFired();
+
+  /**
+   * @brief 向目标队列投递延迟 delay 的唤醒任务
+   * @param delay 延迟时间
+   */
+  void scheduleTimer(std::chrono::steady_clock::duration delay);
+
+  /**
+   * @brief 排空任务：在目标队列的线程上执行最多 maxBatchSize_ 个任务
+   */
+  void drain();
+};
+
+}  // namespace dispatch
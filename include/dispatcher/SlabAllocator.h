@@ -0,0 +1,125 @@
+/**
+ * @file SlabAllocator.h
+ * @brief 定长对象的 slab 分配器
+ *
+ * 用于任务节点等定长对象的池化分配，稳态下不调用 malloc/free。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dispatch {
+
+/**
+ * @brief 分配器统计信息
+ */
+struct AllocatorStats {
+  size_t slabsInUse = 0;         ///< 至少有一个对象正在使用的 slab 数量
+  size_t slabsRetained = 0;      ///< 完全空闲但被保留以备复用的 slab 数量
+  size_t objectsInUse = 0;       ///< 正在使用的对象数量
+  size_t bytesRetained = 0;      ///< 分配器当前持有的全部内存（包括空闲部分）
+  size_t systemAllocations = 0;  ///< 累计向系统申请内存的次数
+  size_t systemReleases = 0;     ///< 累计向系统归还内存的次数
+};
+
+/**
+ * @brief 定长对象的 slab 分配器
+ *
+ * 特性：
+ * - 每个 slab 是一块按自身大小对齐的内存，对象地址取整即可找到所属 slab，释放为 O(1)
+ * - 优先从部分使用的 slab 中分配，使空闲对象集中，便于整块归还
+ * - 高水位裁剪：完全空闲的 slab 超过 maxRetainedSlabs 时归还给系统
+ *
+ * @note 不是线程安全的，需要在外部锁保护下使用
+ */
+class SlabAllocator {
+ public:
+  /// 默认的 slab 大小
+  static constexpr size_t kDefaultSlabSize = 16 * 1024;
+
+  /// 默认保留的空闲 slab 数量
+  static constexpr size_t kDefaultMaxRetainedSlabs = 4;
+
+  /**
+   * @brief 构造函数
+   * @param objectSize 对象大小
+   * @param slabSize slab 大小，必须是 2 的幂且能容纳至少一个对象
+   */
+  explicit SlabAllocator(size_t objectSize, size_t slabSize = kDefaultSlabSize);
+  SlabAllocator(const SlabAllocator& other) = delete;
+  SlabAllocator& operator=(const SlabAllocator& other) = delete;
+
+  /**
+   * @brief 析构函数
+   *
+   * 归还所有 slab。调用前所有对象都应已释放。
+   */
+  ~SlabAllocator();
+
+  /**
+   * @brief 分配一个对象的内存
+   * @return void* 未初始化的内存
+   */
+  void* allocate();
+
+  /**
+   * @brief 释放对象的内存
+   * @param object 由 allocate() 返回的内存（对象需已析构）
+   */
+  void deallocate(void* object);
+
+  /**
+   * @brief 设置保留的空闲 slab 数量上限（高水位）
+   *
+   * 超出部分立即归还给系统。
+   *
+   * @param maxRetainedSlabs 上限
+   */
+  void setMaxRetainedSlabs(size_t maxRetainedSlabs);
+
+  /**
+   * @brief 获取统计信息
+   * @return AllocatorStats 统计信息
+   */
+  AllocatorStats stats() const;
+
+ private:
+  struct FreeObject {
+    FreeObject* next;
+  };
+
+  struct Slab {
+    Slab* prev = nullptr;
+    Slab* next = nullptr;
+    FreeObject* freeList = nullptr;
+    size_t used = 0;
+  };
+
+  struct SlabList {
+    Slab* head = nullptr;
+    size_t count = 0;
+  };
+
+  size_t objectSize_;                                   ///< 对象大小（已按对齐要求取整）
+  size_t slabSize_;                                     ///< slab 大小
+  size_t objectsPerSlab_;                               ///< 每个 slab 可容纳的对象数
+  size_t maxRetainedSlabs_ = kDefaultMaxRetainedSlabs;  ///< 保留的空闲 slab 数量上限
+  SlabList partial_;                                    ///< 部分使用的 slab
+  SlabList full_;                                       ///< 已用满的 slab
+  SlabList empty_;                                      ///< 完全空闲的 slab
+  size_t objectsInUse_ = 0;                             ///< 正在使用的对象数量
+  size_t systemAllocations_ = 0;                        ///< 累计向系统申请内存的次数
+  size_t systemReleases_ = 0;                           ///< 累计向系统归还内存的次数
+
+  Slab* slabOf(void* object) const;
+  Slab* createSlab();
+  void releaseSlab(Slab* slab);
+  void trim();
+
+  static void push(SlabList& list, Slab* slab);
+  static void unlink(SlabList& list, Slab* slab);
+};
+
+}  // namespace dispatch
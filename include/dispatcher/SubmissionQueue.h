@@ -0,0 +1,176 @@
+/**
+ * @file SubmissionQueue.h
+ * @brief 无锁任务提交队列
+ *
+ * 有界的多生产者环形队列，用于在不获取 TaskQueue 互斥锁的情况下提交立即执行的任务。
+ * 由 TaskQueue 内部使用。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "Types.h"
+
+namespace dispatch {
+
+/**
+ * @brief 无锁任务提交队列
+ *
+ * 基于序号的有界环形队列（Vyukov MPMC 算法）：
+ * - 生产者通过 CAS 认领槽位，写入任务后发布序号，全程无锁
+ * - 消费者按认领顺序取出任务；TaskQueue 在持有互斥锁时消费，因此同一时刻只有一个消费者
+ * - 队列满时 tryPush 返回 false，由调用者退回到加锁路径
+ */
+class SubmissionQueue {
+ public:
+  /**
+   * @brief 构造函数
+   * @param capacity 容量，必须是 2 的幂
+   */
+  explicit SubmissionQueue(size_t capacity) : cells_(new Cell[capacity]), mask_(capacity - 1) {
+    for (size_t i = 0; i < capacity; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  SubmissionQueue(const SubmissionQueue& other) = delete;
+  SubmissionQueue& operator=(const SubmissionQueue& other) = delete;
+
+  /**
+   * @brief 尝试提交任务（多生产者安全）
+   * @param id 任务ID
+   * @param function 任务函数，仅在提交成功时被移走
+   * @return true 提交成功
+   * @return false 队列已满
+   */
+  bool tryPush(TaskId id, TaskFunction& function) {
+    auto position = enqueuePosition_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[position & mask_];
+      auto sequence = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+      if (diff == 0) {
+        if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = enqueuePosition_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->id = id;
+    cell->function = std::move(function);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief 检查队首是否有已发布的任务
+   * @return true 可以立即取出任务
+   */
+  bool hasPublished() const {
+    auto position = dequeuePosition_.load(std::memory_order_relaxed);
+    return cells_[position & mask_].sequence.load(std::memory_order_acquire) == position + 1;
+  }
+
+  /**
+   * @brief 获取当前的生产位置
+   *
+   * 与 popUntil 配合使用，可以取出在此之前认领的所有任务。
+   */
+  size_t enqueuePosition() const { return enqueuePosition_.load(std::memory_order_acquire); }
+
+  /**
+   * @brief 获取已认领但尚未取出的任务数量（任意线程，结果只是瞬时的近似值）
+   */
+  size_t size() const {
+    auto dequeue = dequeuePosition_.load(std::memory_order_relaxed);
+    auto enqueue = enqueuePosition_.load(std::memory_order_relaxed);
+    return enqueue > dequeue ? enqueue - dequeue : 0;
+  }
+
+  /**
+   * @brief 取出所有已发布的任务（单消费者）
+   *
+   * 遇到已认领但尚未发布的槽位时停止。
+   *
+   * @param onTask 回调，签名为 void(TaskId, TaskFunction&&)
+   * @return size_t 取出的任务数量
+   */
+  template <typename F>
+  size_t popPublished(F&& onTask) {
+    size_t count = 0;
+    auto position = dequeuePosition_.load(std::memory_order_relaxed);
+    while (true) {
+      auto& cell = cells_[position & mask_];
+      if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+        break;
+      }
+      popCell(cell, position, onTask);
+      position++;
+      count++;
+    }
+    return count;
+  }
+
+  /**
+   * @brief 取出在指定生产位置之前认领的所有任务（单消费者）
+   *
+   * 对于已认领但尚未发布的槽位会短暂让出 CPU 等待其发布。
+   * 生产者从认领到发布之间只有一次函数对象的移动，等待时间极短。
+   *
+   * @param end 由 enqueuePosition() 获取的生产位置
+   * @param onTask 回调，签名为 void(TaskId, TaskFunction&&)
+   * @return size_t 取出的任务数量
+   */
+  template <typename F>
+  size_t popUntil(size_t end, F&& onTask) {
+    size_t count = 0;
+    auto position = dequeuePosition_.load(std::memory_order_relaxed);
+    while (position != end) {
+      auto& cell = cells_[position & mask_];
+      if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+        std::this_thread::yield();
+        continue;
+      }
+      popCell(cell, position, onTask);
+      position++;
+      count++;
+    }
+    return count;
+  }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  struct Cell {
+    std::atomic<size_t> sequence{0};  ///< 槽位序号
+    TaskId id = 0;                    ///< 任务ID
+    TaskFunction function;            ///< 任务函数
+  };
+
+  std::unique_ptr<Cell[]> cells_;                                   ///< 槽位数组
+  size_t mask_;                                                     ///< 容量掩码
+  alignas(kCacheLineSize) std::atomic<size_t> enqueuePosition_{0};  ///< 生产位置
+  alignas(kCacheLineSize) std::atomic<size_t> dequeuePosition_{0};  ///< 消费位置
+
+  template <typename F>
+  void popCell(Cell& cell, size_t position, F& onTask) {
+    auto id = cell.id;
+    auto function = std::move(cell.function);
+    cell.function = TaskFunction();
+    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+    dequeuePosition_.store(position + 1, std::memory_order_relaxed);
+    onTask(id, std::move(function));
+  }
+};
+
+}  // namespace dispatch
@@ -0,0 +1,200 @@
+/**
+ * @file TaskFunction.h
+ * @brief 仅可移动的任务函数类型
+ *
+ * 带小对象缓冲区的类型擦除可调用对象，用于替代 std::function 存储任务。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "ClosureAllocator.h"
+
+namespace dispatch {
+
+/**
+ * @brief 仅可移动的任务函数
+ *
+ * 与 std::function<void()> 的区别：
+ * - 仅可移动，因此可以捕获 std::unique_ptr、std::promise 等仅可移动的对象
+ * - 内联缓冲区为 kInlineSize 字节，常见的 lambda（捕获若干指针、std::shared_ptr、
+ *   std::string 或 std::function）不需要堆分配
+ * - 超出内联缓冲区的闭包从 ClosureAllocator 的线程缓存中分配，稳态下不调用 malloc/free
+ * - 可以从任意 void() 可调用对象隐式构造，包括 std::function，
+ *   空的 std::function 或空函数指针会得到空的 TaskFunction
+ *
+ * 使用示例：
+ * @code
+ * auto data = std::make_unique<Data>();
+ * queue->async([data = std::move(data)]() { process(*data); });
+ * @endcode
+ */
+class TaskFunction {
+ public:
+  /// 内联缓冲区大小，闭包不超过此大小时不分配堆内存
+  static constexpr size_t kInlineSize = 48;
+
+  TaskFunction() noexcept = default;
+  TaskFunction(std::nullptr_t) noexcept {}
+
+  /**
+   * @brief 从可调用对象构造
+   * @param function 可调用对象
+   */
+  template <typename F, typename D = std::decay_t<F>,
+            typename = std::enable_if_t<!std::is_same<D, TaskFunction>::value && std::is_invocable_r<void, D&>::value>>
+  TaskFunction(F&& function) {
+    if (isNull(function)) {
+      return;
+    }
+    construct<D>(std::forward<F>(function));
+  }
+
+  TaskFunction(TaskFunction&& other) noexcept { moveFrom(other); }
+
+  TaskFunction& operator=(TaskFunction&& other) noexcept {
+    if (this != &other) {
+      reset();
+      moveFrom(other);
+    }
+    return *this;
+  }
+
+  TaskFunction& operator=(std::nullptr_t) noexcept {
+    reset();
+    return *this;
+  }
+
+  TaskFunction(const TaskFunction& other) = delete;
+  TaskFunction& operator=(const TaskFunction& other) = delete;
+
+  ~TaskFunction() { reset(); }
+
+  /// 是否持有可调用对象
+  explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+  /**
+   * @brief 调用任务函数
+   * @throw std::bad_function_call 任务函数为空时
+   */
+  void operator()() const {
+    if (ops_ == nullptr) {
+      throw std::bad_function_call();
+    }
+    ops_->invoke(storage_);
+  }
+
+  /**
+   * @brief 检查可调用对象是否会存放在内联缓冲区中
+   * @tparam F 可调用对象类型
+   */
+  template <typename F>
+  static constexpr bool fitsInline() {
+    return sizeof(F) <= kInlineSize && alignof(F) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible<F>::value;
+  }
+
+ private:
+  struct Ops {
+    void (*invoke)(void* storage);
+    void (*move)(void* to, void* from) noexcept;  ///< 移动构造到 to 并销毁 from
+    void (*destroy)(void* storage) noexcept;
+  };
+
+  template <typename F>
+  struct InlineOps {
+    static F* get(void* storage) { return std::launder(reinterpret_cast<F*>(storage)); }
+    static void invoke(void* storage) { (*get(storage))(); }
+    static void move(void* to, void* from) noexcept {
+      ::new (to) F(std::move(*get(from)));
+      get(from)->~F();
+    }
+    static void destroy(void* storage) noexcept { get(storage)->~F(); }
+    static constexpr Ops ops{&invoke, &move, &destroy};
+  };
+
+  template <typename F>
+  struct HeapOps {
+    static F*& get(void* storage) { return *std::launder(reinterpret_cast<F**>(storage)); }
+    static void invoke(void* storage) { (*get(storage))(); }
+    static void move(void* to, void* from) noexcept { ::new (to) F*(get(from)); }
+    static void destroy(void* storage) noexcept {
+      auto* function = get(storage);
+      function->~F();
+      deallocate(function);
+    }
+    static constexpr Ops ops{&invoke, &move, &destroy};
+
+    template <typename Arg>
+    static F* create(Arg&& function) {
+      // 超出基本对齐要求的闭包无法放入 ClosureAllocator 的块中
+      if constexpr (alignof(F) > alignof(std::max_align_t)) {
+        return new F(std::forward<Arg>(function));
+      } else {
+        void* memory = ClosureAllocator::allocate(sizeof(F));
+        try {
+          return ::new (memory) F(std::forward<Arg>(function));
+        } catch (...) {
+          ClosureAllocator::deallocate(memory, sizeof(F));
+          throw;
+        }
+      }
+    }
+
+    static void deallocate(F* function) noexcept {
+      if constexpr (alignof(F) > alignof(std::max_align_t)) {
+        ::operator delete(static_cast<void*>(function), std::align_val_t(alignof(F)));
+      } else {
+        ClosureAllocator::deallocate(function, sizeof(F));
+      }
+    }
+  };
+
+  alignas(std::max_align_t) mutable unsigned char storage_[kInlineSize];
+  const Ops* ops_ = nullptr;
+
+  template <typename F>
+  static bool isNull(const F& function) {
+    if constexpr (std::is_pointer<F>::value || std::is_member_pointer<F>::value) {
+      return function == nullptr;
+    } else if constexpr (std::is_same<F, std::function<void()>>::value) {
+      return !function;
+    } else {
+      return false;
+    }
+  }
+
+  template <typename D, typename F>
+  void construct(F&& function) {
+    if constexpr (fitsInline<D>()) {
+      ::new (static_cast<void*>(storage_)) D(std::forward<F>(function));
+      ops_ = &InlineOps<D>::ops;
+    } else {
+      ::new (static_cast<void*>(storage_)) D*(HeapOps<D>::create(std::forward<F>(function)));
+      ops_ = &HeapOps<D>::ops;
+    }
+  }
+
+  void moveFrom(TaskFunction& other) noexcept {
+    if (other.ops_ != nullptr) {
+      other.ops_->move(storage_, other.storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+
+  void reset() noexcept {
+    if (ops_ != nullptr) {
+      auto* ops = ops_;
+      ops_ = nullptr;
+      ops->destroy(storage_);
+    }
+  }
+};
+
+}  // namespace dispatch
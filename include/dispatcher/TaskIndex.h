@@ -0,0 +1,153 @@
+/**
+ * @file TaskIndex.h
+ * @brief 任务ID索引
+ *
+ * 从任务ID到任务节点的开放寻址哈希表，用于 O(1) 查找待取消的任务。
+ * 由 TaskQueue 内部使用，本身不是线程安全的，需要在外部锁保护下访问。
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Types.h"
+
+namespace dispatch {
+
+/**
+ * @brief 任务ID索引
+ *
+ * 线性探测 + 后移删除的开放寻址哈希表：
+ * - 插入/查找/删除均为均摊 O(1)
+ * - 删除不留墓碑，长时间运行也不会退化
+ * - 稳态下不分配内存（仅在容量不足时扩容）
+ *
+ * @tparam Node 节点类型
+ * @note 任务ID必须大于 0，0 用于表示空槽位
+ */
+template <typename Node>
+class TaskIndex {
+ public:
+  TaskIndex() { rehash(kInitialCapacity); }
+
+  /// 索引中的任务数量
+  size_t size() const { return size_; }
+
+  /**
+   * @brief 插入任务
+   * @param id 任务ID（不能已存在）
+   * @param node 任务节点
+   */
+  void insert(TaskId id, Node* node) {
+    if ((size_ + 1) * 2 > entries_.size()) {
+      rehash(entries_.size() * 2);
+    }
+    auto index = slotOf(id);
+    while (entries_[index].id != 0) {
+      index = (index + 1) & mask_;
+    }
+    entries_[index].id = id;
+    entries_[index].node = node;
+    size_++;
+  }
+
+  /**
+   * @brief 查找任务
+   * @param id 任务ID
+   * @return Node* 任务节点，不存在时返回 nullptr
+   */
+  Node* find(TaskId id) const {
+    auto index = slotOf(id);
+    while (entries_[index].id != 0) {
+      if (entries_[index].id == id) {
+        return entries_[index].node;
+      }
+      index = (index + 1) & mask_;
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief 删除任务
+   * @param id 任务ID
+   * @return Node* 被删除的任务节点，不存在时返回 nullptr
+   */
+  Node* erase(TaskId id) {
+    auto index = slotOf(id);
+    while (entries_[index].id != id) {
+      if (entries_[index].id == 0) {
+        return nullptr;
+      }
+      index = (index + 1) & mask_;
+    }
+
+    auto* node = entries_[index].node;
+    size_--;
+
+    // 后移删除：把探测链上后续的条目前移填补空位
+    auto hole = index;
+    auto next = (hole + 1) & mask_;
+    while (entries_[next].id != 0) {
+      auto ideal = slotOf(entries_[next].id);
+      // 条目的理想位置不在 (hole, next] 区间内时，可以前移到空位
+      bool movable = hole <= next ? (ideal <= hole || ideal > next) : (ideal <= hole && ideal > next);
+      if (movable) {
+        entries_[hole] = entries_[next];
+        hole = next;
+      }
+      next = (next + 1) & mask_;
+    }
+    entries_[hole] = Entry();
+    return node;
+  }
+
+  /// 清空索引
+  void clear() {
+    for (auto& entry : entries_) {
+      entry = Entry();
+    }
+    size_ = 0;
+  }
+
+ private:
+  static constexpr size_t kInitialCapacity = 64;
+
+  struct Entry {
+    TaskId id = 0;         ///< 任务ID，0 表示空槽位
+    Node* node = nullptr;  ///< 任务节点
+  };
+
+  std::vector<Entry> entries_;  ///< 槽位数组（容量为 2 的幂）
+  size_t mask_ = 0;             ///< 容量掩码
+  int shift_ = 0;               ///< 斐波那契哈希的右移位数
+  size_t size_ = 0;             ///< 条目数量
+
+  size_t slotOf(TaskId id) const {
+    // 斐波那契哈希：连续的任务ID会被打散到整个表中
+    return static_cast<size_t>((static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ull) >> shift_);
+  }
+
+  void rehash(size_t capacity) {
+    std::vector<Entry> old;
+    old.swap(entries_);
+    entries_.resize(capacity);
+    mask_ = capacity - 1;
+    shift_ = 64;
+    while (capacity > 1) {
+      capacity >>= 1;
+      shift_--;
+    }
+    for (const auto& entry : old) {
+      if (entry.id != 0) {
+        auto index = slotOf(entry.id);
+        while (entries_[index].id != 0) {
+          index = (index + 1) & mask_;
+        }
+        entries_[index] = entry;
+      }
+    }
+  }
+};
+
+}  // namespace dispatch
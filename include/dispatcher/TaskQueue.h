@@ -8,16 +8,26 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <vector>
 
+#include "Backpressure.h"
+#include "Deadline.h"
 #include "IDispatchQueue.h"
 #include "IQueueListener.h"
+#include "SlabAllocator.h"
+#include "SubmissionQueue.h"
+#include "TaskIndex.h"
+#include "ThreadQoS.h"
+#include "TimerWheel.h"
 #include "Types.h"
 
 namespace dispatch {
@@ -25,28 +35,50 @@ namespace dispatch {
 /**
  * @brief 入队任务的返回信息
  *
- * 包含任务ID和是否为队列的第一个任务的标志。
+ * 包含任务ID和是否需要（重新）启动工作线程的标志。
  */
 struct EnqueuedTask {
   TaskId id = 0;         ///< 任务的唯一标识符
-  bool isFirst = false;  ///< 是否是队列创建后的第一个任务（用于启动工作线程）
+  bool isFirst = false;  ///< 是否是队列创建后（或工作线程经 retireWorkerIfIdle() 退出后）的第一个任务
 };
 
 /**
  * @brief 任务队列
  *
  * 线程安全的任务队列实现，特性：
- * - 按执行时间排序的优先队列
- * - 支持延迟执行
- * - 支持任务取消
+ * - 就绪任务先入先出，立即执行的任务入队时无需读取时钟
+ * - 优先级通道：任务可以指定优先级（ThreadQoSClass），每个优先级一个先入先出的就绪通道，
+ *   高优先级通道先执行；较低的非空通道每被抢先 kPriorityAgingLimit 次就执行一次（老化），不会饥饿；
+ *   延迟任务到期后进入各自的通道
+ * - 截止时间：任务可以携带完成截止时间；EDF 策略下按截止时间先于各通道执行（同样参与老化），
+ *   开始时已超时的任务按错过策略照常执行或丢弃，并统计错过截止时间的次数
+ * - 有界队列：可以设置容量，队列已满时按溢出策略阻塞生产者或丢弃任务；tryEnqueue 不阻塞，
+ *   队列已满时返回 false，并可以登记腾出空间时的回调
+ * - 立即执行的任务通过无锁提交队列入队，多生产者之间不竞争互斥锁
+ *   （延迟任务、屏障、取消以及设置了监听器或容量时仍走加锁路径）
+ * - 支持延迟执行（未到期的任务存放在分层时间轮中，插入和取消均为 O(1)，
+ *   到期后按执行时间批量移入就绪队列）
+ * - 支持任务取消（通过任务ID索引 O(1) 定位，就绪任务标记为墓碑，到达队首时再回收）
  * - 支持屏障同步（barrier）
+ * - 任务节点从 slab 分配器中分配，就绪队列为侵入式链表，稳态下入队/出队不分配内存
  * - 可配置的并发任务数
- * - 状态监听器支持
+ * - 状态监听器支持（回调在释放互斥锁后按事件产生顺序调用，回调中可以再次操作队列）
+ * - 定向唤醒：空闲的工作线程在各自的条件变量上等待，新任务就绪时只唤醒所需数量的线程，
+ *   延迟任务只由一个线程（timer leader）负责等待到期；屏障和并发数受限的等待使用单独的条件变量
  *
  * @note TaskQueue 本身不创建线程，需要外部调用 runNextTask() 来执行任务
  */
 class TaskQueue : public IDispatchQueue {
  public:
+  /// 表示“立即执行”的执行时间，传给 enqueue 时任务直接进入就绪队列
+  static constexpr std::chrono::steady_clock::time_point kImmediate = std::chrono::steady_clock::time_point::min();
+
+  /// 表示“无限等待”的最大等待时间，传给 runNextTask 时空闲线程一直阻塞，直到有新任务或队列被销毁
+  static constexpr std::chrono::steady_clock::time_point kForever = std::chrono::steady_clock::time_point::max();
+
+  /// 表示“没有截止时间”
+  static constexpr std::chrono::steady_clock::time_point kNoDeadline = std::chrono::steady_clock::time_point::max();
+
   TaskQueue();
   TaskQueue(const TaskQueue& other) = delete;
   ~TaskQueue() override;
@@ -64,7 +96,7 @@ class TaskQueue : public IDispatchQueue {
    * @param function 任务函数
    * @return EnqueuedTask 包含任务ID和是否首个任务的信息
    */
-  EnqueuedTask enqueue(DispatchFunction function);
+  EnqueuedTask enqueue(TaskFunction function);
 
   /**
    * @brief 入队任务（延迟执行）
@@ -72,7 +104,7 @@ class TaskQueue : public IDispatchQueue {
    * @param delay 延迟时间
    * @return EnqueuedTask 包含任务ID和是否首个任务的信息
    */
-  EnqueuedTask enqueue(DispatchFunction function, std::chrono::steady_clock::duration delay);
+  EnqueuedTask enqueue(TaskFunction function, std::chrono::steady_clock::duration delay);
 
   /**
    * @brief 入队任务（指定执行时间）
@@ -80,7 +112,97 @@ class TaskQueue : public IDispatchQueue {
    * @param executeTime 执行时间点
    * @return EnqueuedTask 包含任务ID和是否首个任务的信息
    */
-  EnqueuedTask enqueue(DispatchFunction function, std::chrono::steady_clock::time_point executeTime);
+  EnqueuedTask enqueue(TaskFunction function, std::chrono::steady_clock::time_point executeTime);
+
+  /**
+   * @brief 按优先级入队任务（立即执行）
+   *
+   * 非默认优先级的任务走加锁路径。
+   *
+   * @param function 任务函数
+   * @param priority 优先级
+   * @return EnqueuedTask 包含任务ID和是否首个任务的信息
+   */
+  EnqueuedTask enqueue(TaskFunction function, ThreadQoSClass priority);
+
+  /**
+   * @brief 按优先级入队任务（指定执行时间）
+   *
+   * 任务到期后进入其优先级的就绪通道。
+   *
+   * @param function 任务函数
+   * @param executeTime 执行时间点，kImmediate 表示立即执行
+   * @param priority 优先级
+   * @return EnqueuedTask 包含任务ID和是否首个任务的信息
+   */
+  EnqueuedTask enqueue(TaskFunction function, std::chrono::steady_clock::time_point executeTime,
+                       ThreadQoSClass priority);
+
+  /**
+   * @brief 入队带完成截止时间的任务（立即执行）
+   *
+   * SchedulingPolicy::EarliestDeadlineFirst 下按截止时间排序，否则进入其优先级通道；
+   * 开始执行时已超过截止时间的任务按 setDeadlineMissPolicy() 处理。走加锁路径。
+   *
+   * @param function 任务函数
+   * @param deadline 截止时间，kNoDeadline 与 enqueue(function, priority) 相同
+   * @param priority 优先级（EDF 策略下带截止时间的任务不使用优先级）
+   * @return EnqueuedTask 包含任务ID和是否首个任务的信息
+   */
+  EnqueuedTask enqueueWithDeadline(TaskFunction function, std::chrono::steady_clock::time_point deadline,
+                                   ThreadQoSClass priority = kThreadQoSClassNormal);
+
+  /**
+   * @brief 尝试入队任务（立即执行），队列已满时不阻塞也不丢弃
+   *
+   * 没有设置容量时与 enqueue(function) 相同。
+   *
+   * @param function 任务函数，未入队时保持不变，可以稍后重试
+   * @return EnqueuedTask 包含任务ID和是否首个任务的信息，任务ID为 0 表示队列已满或已销毁
+   */
+  EnqueuedTask tryEnqueue(TaskFunction&& function);
+
+  /**
+   * @brief 尝试入队任务（立即执行），队列已满时登记腾出空间时的回调
+   *
+   * 队列已满时不入队，并保存 onSpaceAvailable：之后有任务开始执行（或被取消、丢弃）腾出空间时，
+   * 在腾出空间的线程上、不持有队列锁时调用一次，调用者通常在回调中重试。腾出的空间优先留给阻塞的生产者，
+   * 多个回调按登记顺序调用，调用的数量不超过腾出的空间。队列销毁时未调用的回调被丢弃。
+   *
+   * @param function 任务函数，未入队时保持不变，可以稍后重试
+   * @param onSpaceAvailable 腾出空间时的回调，只在队列已满时保存（队列已销毁时不保存）
+   * @return EnqueuedTask 包含任务ID和是否首个任务的信息，任务ID为 0 表示未入队
+   */
+  EnqueuedTask tryEnqueue(TaskFunction&& function, TaskFunction onSpaceAvailable);
+
+  /**
+   * @brief 批量入队任务（立即执行）
+   *
+   * 任务ID连续分配，在一次加锁内全部插入，并只唤醒一次工作线程。
+   *
+   * @param functions 任务函数
+   * @return EnqueuedTask 第一个任务的ID（其余依次加一）和是否首个任务的信息
+   */
+  EnqueuedTask enqueueBatch(std::vector<TaskFunction> functions);
+
+  /**
+   * @brief 批量入队任务（延迟执行）
+   * @param functions 任务函数
+   * @param delay 延迟时间
+   * @return EnqueuedTask 第一个任务的ID（其余依次加一）和是否首个任务的信息
+   */
+  EnqueuedTask enqueueBatch(std::vector<TaskFunction> functions, std::chrono::steady_clock::duration delay);
+
+  /**
+   * @brief 批量入队任务（指定执行时间）
+   *
+   * 所有任务共享同一个执行时间，到期后按数组顺序执行。
+   *
+   * @param functions 任务函数
+   * @param executeTime 执行时间点
+   * @return EnqueuedTask 第一个任务的ID（其余依次加一）和是否首个任务的信息
+   */
+  EnqueuedTask enqueueBatch(std::vector<TaskFunction> functions, std::chrono::steady_clock::time_point executeTime);
 
   /**
    * @brief 屏障同步
@@ -90,13 +212,23 @@ class TaskQueue : public IDispatchQueue {
    *
    * @param function 屏障函数
    */
-  void barrier(const DispatchFunction& function);
+  void barrier(const TaskFunction& function);
 
-  // IDispatchQueue 接口实现
-  void sync(const DispatchFunction& function) final;
-  void async(DispatchFunction function) final;
-  TaskId asyncAfter(DispatchFunction function, std::chrono::steady_clock::duration delay) final;
+  // IDispatchQueue 接口实现（保留接受 DispatchGroup 的重载）
+  using IDispatchQueue::async;
+  using IDispatchQueue::asyncAfter;
+  using IDispatchQueue::asyncWithDeadline;
+  void sync(const TaskFunction& function) final;
+  void async(TaskFunction function) final;
+  TaskId asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay) final;
+  void asyncBatch(std::vector<TaskFunction> functions) final;
+  TaskId asyncBatchAfter(std::vector<TaskFunction> functions, std::chrono::steady_clock::duration delay) final;
   void cancel(TaskId taskId) final;
+  void async(TaskFunction function, ThreadQoSClass priority) final;
+  TaskId asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay, ThreadQoSClass priority) final;
+  void asyncWithDeadline(TaskFunction function, std::chrono::steady_clock::duration deadline) final;
+  bool tryAsync(TaskFunction&& function) final;
+  bool tryAsync(TaskFunction&& function, TaskFunction onSpaceAvailable) final;
 
   /**
    * @brief 运行下一个任务
@@ -110,6 +242,56 @@ class TaskQueue : public IDispatchQueue {
    */
   bool runNextTask(std::chrono::steady_clock::time_point maxTime);
 
+  /**
+   * @brief 批量运行就绪任务
+   *
+   * 串行队列（最大并发数为 1）一次加锁取出最多 maxBatch 个连续的就绪任务，
+   * 在锁外依次执行，最后再加锁一次回收，减少每个任务的加锁次数。
+   * 遇到屏障时停止取出；已取出但尚未执行的任务仍可被 cancel() 取消。
+   * 并发队列每次只取一个任务。
+   *
+   * @param maxTime 最大等待时间点
+   * @param maxBatch 一次最多取出的任务数
+   * @return size_t 执行的任务数量（超时或队列已销毁时为 0）
+   */
+  size_t runNextTasks(std::chrono::steady_clock::time_point maxTime, size_t maxBatch);
+
+  /**
+   * @brief 让一个空闲等待的线程从 runNextTask 返回
+   *
+   * 唤醒一个正在 runNextTask/runNextTasks 中等待的线程（等待新任务、并发名额或屏障），使其返回 false；
+   * 如果当前没有空闲线程，则由下一个进入空闲等待的线程立即返回。多次请求在被响应前合并为一次。
+   * 用于外部调度器（例如线程池的工作窃取）通知工作线程有队列之外的工作。
+   */
+  void interruptWait();
+
+  /**
+   * @brief 让一个空闲等待的线程从 runNextTask 返回，优先选择指定等待组中的线程
+   *
+   * 与 interruptWait() 相同，但优先唤醒通过 setThreadWaitGroup() 登记为 group 的线程
+   * （例如同一 NUMA 节点上的工作线程），该组没有空闲线程时再唤醒其他线程。
+   *
+   * @param group 优先唤醒的等待组
+   */
+  void interruptWait(size_t group);
+
+  /**
+   * @brief 设置调用线程的等待组（默认为 0），供 interruptWait(group) 选择唤醒的线程
+   * @param group 等待组
+   */
+  static void setThreadWaitGroup(size_t group);
+
+  /**
+   * @brief 工作线程空闲退出前的交接
+   *
+   * 队列为空（没有就绪任务、延迟任务和正在执行的任务）时重新设置首任务标记并返回 true，
+   * 调用线程可以退出：之后第一个入队任务的 EnqueuedTask::isFirst 为 true，由提交者重新启动工作线程。
+   * 队列不为空时返回 false，调用线程应继续执行任务。
+   *
+   * @return true 队列为空，调用线程可以退出
+   */
+  bool retireWorkerIfIdle();
+
   /**
    * @brief 运行下一个任务（不等待）
    * @return true 如果执行了任务
@@ -143,6 +325,9 @@ class TaskQueue : public IDispatchQueue {
 
   /**
    * @brief 设置队列监听器
+   *
+   * 监听器回调不在持有队列锁时调用；同一队列的回调不会并发执行，且按状态变化的顺序调用。
+   *
    * @param listener 监听器对象
    */
   void setListener(const std::shared_ptr<IQueueListener>& listener);
@@ -156,6 +341,134 @@ class TaskQueue : public IDispatchQueue {
    */
   void setMaxConcurrentTasks(size_t maxConcurrentTasks);
 
+  /**
+   * @brief 设置就绪任务的调度策略
+   *
+   * 只影响之后就绪的任务，已经在队列中的任务保持原来的位置。
+   *
+   * @param policy 调度策略
+   */
+  void setSchedulingPolicy(SchedulingPolicy policy);
+
+  /**
+   * @brief 设置开始执行时已超过截止时间的任务的处理方式
+   * @param policy 错过截止时间的处理方式
+   */
+  void setDeadlineMissPolicy(DeadlineMissPolicy policy);
+
+  /**
+   * @brief 获取带截止时间的任务的统计信息
+   *
+   * runNextTasks() 批量执行的任务在整批结束后计入。
+   *
+   * @return DeadlineStats 统计信息
+   */
+  DeadlineStats deadlineStats() const;
+
+  /**
+   * @brief 当前线程正在执行的任务是否在超过截止时间后才开始执行
+   *
+   * 供任务在已经超时时降级处理（例如跳过非必要的工作）。没有截止时间或不在任务中时返回 false。
+   *
+   * @return true 任务开始时已超过截止时间
+   */
+  static bool currentTaskMissedDeadline();
+
+  /**
+   * @brief 设置队列容量和溢出策略
+   *
+   * 容量是等待执行的任务数上限，包括尚未到期的延迟任务，不包括正在执行的任务和 sync/barrier。
+   * 队列已满时 enqueue/enqueueBatch/enqueueWithDeadline 按 policy 处理：
+   * - Block：阻塞到有足够的空间；超过容量的批量任务等队列排空后整批入队
+   * - DropOldest：丢弃最早排队的就绪任务（从最低优先级的通道开始，没有通道任务时取 EDF 堆顶）；
+   *   只有延迟任务时丢弃新任务
+   * - DropNewest：丢弃新任务（批量任务丢弃超出部分），返回的任务ID为 0
+   * 被丢弃的任务函数在锁外销毁（加入调度组的任务离开组）。
+   * 通过 setThreadWorkerQueue() 登记为本队列工作线程的线程提交时不受容量限制，避免等待自己或丢弃自身产生的后续任务；
+   * 通过 setThreadCapacityExempt() 豁免的提交同样不受限制。
+   * 缩小容量不会移除已经入队的任务。设置了容量的队列所有提交都走加锁路径。
+   *
+   * @param capacity 容量，0 表示不限制（默认）
+   * @param policy 溢出策略
+   */
+  void setCapacity(size_t capacity, OverflowPolicy policy = OverflowPolicy::Block);
+
+  /**
+   * @brief 获取队列容量（无锁读取）
+   * @return size_t 容量，0 表示不限制
+   */
+  size_t capacity() const { return capacity_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 获取有界队列的统计信息
+   * @return OverflowStats 统计信息
+   */
+  OverflowStats overflowStats() const;
+
+  /**
+   * @brief 登记调用线程为 queue 的工作线程
+   *
+   * 工作线程向自己的队列提交时不受容量限制（见 setCapacity）。在任务中临时登记的调用者应恢复返回值。
+   *
+   * @param queue 队列，nullptr 表示取消登记
+   * @return const TaskQueue* 之前登记的队列
+   */
+  static const TaskQueue* setThreadWorkerQueue(const TaskQueue* queue);
+
+  /**
+   * @brief 设置调用线程的提交是否不受任何队列的容量限制
+   *
+   * SerialDispatchQueue 向目标队列投递排空任务和唤醒任务时使用：这些任务被阻塞或丢弃会使串行队列停止执行。
+   * 不影响 tryEnqueue。调用者应恢复返回值。
+   *
+   * @param exempt 是否不受限制
+   * @return bool 之前的设置
+   */
+  static bool setThreadCapacityExempt(bool exempt);
+
+  /**
+   * @brief 设置任务节点分配器保留的空闲 slab 数量上限（高水位）
+   *
+   * 突发负载过后，超出上限的空闲 slab 会归还给系统。
+   *
+   * @param maxRetainedSlabs 上限
+   */
+  void setMaxRetainedSlabs(size_t maxRetainedSlabs);
+
+  /**
+   * @brief 获取任务节点分配器的统计信息
+   * @return AllocatorStats 统计信息
+   */
+  AllocatorStats allocatorStats() const;
+
+  /**
+   * @brief 获取等待执行的任务数量
+   *
+   * 包括已提交尚未入队的任务和就绪队列中的任务，不包括尚未到期的延迟任务。
+   * 无锁读取，结果只是近似值（可能包含已取消任务的墓碑），适合用作负载指标。
+   *
+   * @return size_t 任务数量
+   */
+  size_t pendingTaskCount() const;
+
+  /**
+   * @brief 获取优先级不低于 minPriority 的就绪任务数量
+   *
+   * 无锁读取的近似值，不包括无锁提交队列中的任务（都是默认优先级）和尚未到期的延迟任务；
+   * EDF 策略下按截止时间排序的任务总是计算在内。
+   * 外部调度器可以据此判断是否需要优先检查本队列。
+   *
+   * @param minPriority 最低优先级
+   * @return size_t 任务数量
+   */
+  size_t pendingTaskCount(ThreadQoSClass minPriority) const;
+
+  /**
+   * @brief 获取正在等待新任务的线程数量（无锁读取，结果只是瞬时值）
+   * @return size_t 线程数量
+   */
+  size_t idleThreadCount() const { return waiters_.load(std::memory_order_relaxed); }
+
   // 仅用于测试
   std::shared_ptr<IQueueListener> getListener() const;
 
@@ -163,49 +476,575 @@ class TaskQueue : public IDispatchQueue {
   /**
    * @brief 内部任务结构
    */
-  struct Task {
-    TaskId id;                                          ///< 任务ID
-    DispatchFunction function;                          ///< 任务函数
-    std::chrono::steady_clock::time_point executeTime;  ///< 执行时间
-    bool isBarrier;                                     ///< 是否为屏障任务
+  struct Task : TimerWheelHook {
+    uint32_t sequence = 0;  ///< 进入就绪队列的顺序（屏障据此划分前后，回绕比较）
+    TaskId id;              ///< 任务ID
+    TaskFunction function;  ///< 任务函数
+    // 进入就绪队列时赋值 deadline 切换活动成员，之后只通过 deadline 访问
+    union {
+      std::chrono::steady_clock::time_point executeTime;  ///< 执行时间（在时间轮中时）
+      std::chrono::steady_clock::time_point deadline;     ///< 截止时间（就绪后，kNoDeadline 表示没有）
+    };
+    bool isBarrier;                            ///< 是否为屏障任务
+    uint8_t priority = kThreadQoSClassNormal;  ///< 优先级（就绪通道）
+    bool delayed = false;                      ///< 是否在时间轮中
+    bool cancelled = false;                    ///< 是否已取消（墓碑）
+    bool claimed = false;                      ///< 是否已被 runNextTasks 批量取出
+    std::atomic_bool settled{false};           ///< 批量取出后由执行方或取消方之一认领
+
+    Task(TaskId id, TaskFunction function, std::chrono::steady_clock::time_point executeTime, bool isBarrier);
+  };
+
+  /**
+   * @brief 就绪任务链表
+   *
+   * 通过 TimerWheelHook::next 串联（就绪任务不在时间轮中，两者不会冲突），入队/出队不分配内存。
+   */
+  struct ReadyList {
+    Task* head = nullptr;  ///< 队首
+    Task* tail = nullptr;  ///< 队尾
+    /// 节点数量（包括墓碑和屏障）；只在持有 mutex_ 时修改，可以无锁读取近似值
+    std::atomic<size_t> count{0};
 
-    Task(TaskId id, DispatchFunction function, std::chrono::steady_clock::time_point executeTime, bool isBarrier);
+    bool empty() const { return head == nullptr; }
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+    Task* front() const { return head; }
+
+    void push_back(Task* task) {
+      task->next = nullptr;
+      if (tail == nullptr) {
+        head = task;
+      } else {
+        tail->next = task;
+      }
+      tail = task;
+      count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void pop_front() {
+      head = static_cast<Task*>(head->next);
+      count.store(count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+      if (head == nullptr) {
+        tail = nullptr;
+      }
+    }
   };
 
-  std::atomic_bool disposed_;                 ///< 队列是否已销毁
-  mutable std::mutex mutex_;                  ///< 保护队列的互斥锁
-  std::condition_variable condition_;         ///< 条件变量，用于等待任务
-  TaskId taskIdCounter_{0};                   ///< 任务ID计数器
-  std::deque<Task> tasks_;                    ///< 任务队列（按执行时间排序）
-  bool empty_ = true;                         ///< 队列是否为空
-  bool first_ = true;                         ///< 是否为第一个任务
-  size_t currentRunningTasks_ = 0;            ///< 当前正在执行的任务数
-  size_t maxConcurrentTasks_ = 1;             ///< 最大并发任务数
-  std::shared_ptr<IQueueListener> listener_;  ///< 队列监听器
+  /// 就绪队列的优先级通道数量（每个 ThreadQoSClass 一个）
+  static constexpr size_t kPriorityLanes = kThreadQoSClassMax + 1;
+
+  /// ReadyQueue::select() 的返回值：按截止时间排序的任务
+  static constexpr size_t kDeadlineLane = kPriorityLanes;
+
+  /// ReadyQueue::select() 的返回值：屏障
+  static constexpr size_t kBarrierLane = kPriorityLanes + 1;
+
+  /// 非空的较低通道被更高通道连续抢先多少次后先执行一个它的任务
+  static constexpr uint32_t kPriorityAgingLimit = 16;
+
+  /**
+   * @brief 分优先级通道的就绪队列
+   *
+   * 每个优先级一个 ReadyList，屏障单独存放；EDF 策略下带截止时间的任务放在按 (截止时间, 进入顺序) 排序的
+   * 小顶堆中，堆中只有进入顺序早于最早屏障的任务，屏障之后到达的先放在 deferred 中，屏障执行后再入堆。
+   * front() 的选择规则：
+   * - 只考虑堆顶和进入顺序早于最早屏障的通道头部；没有这样的任务时队首是屏障
+   * - 堆顶优先，其次是优先级最高的通道，除非更低的通道已被连续抢先 kPriorityAgingLimit 次（取其中最高的）
+   * front() 不修改状态，pop_front() 移除 front() 并更新老化计数，两者之间不能插入任务。
+   */
+  struct ReadyQueue {
+    ReadyList lanes[kPriorityLanes];        ///< 各优先级的就绪任务
+    ReadyList barriers;                     ///< 屏障任务（按插入顺序）
+    std::vector<Task*> deadlines;           ///< 按截止时间排序的任务（小顶堆）
+    ReadyList deferred;                     ///< 屏障之后到达、等待入堆的带截止时间的任务
+    std::atomic<size_t> deadlineCount{0};   ///< 堆中的任务数量，可以无锁读取近似值
+    uint32_t skipped[kPriorityLanes] = {};  ///< 各通道连续被更高通道抢先的次数
+    uint32_t nonEmptyLanes = 0;             ///< 非空通道的位图（kDeadlineLane 位表示堆非空）
+    uint32_t sequence = 0;                  ///< 已分配的进入顺序
+    bool earliestDeadlineFirst = false;     ///< 带截止时间的任务是否按截止时间排序
+
+    bool empty() const { return nonEmptyLanes == 0 && barriers.empty(); }
+
+    size_t size() const {
+      size_t total = barriers.size() + deferred.size() + deadlineCount.load(std::memory_order_relaxed);
+      for (auto& lane : lanes) {
+        total += lane.size();
+      }
+      return total;
+    }
+
+    Task* front() const {
+      auto lane = select();
+      if (lane == kDeadlineLane) {
+        return deadlines.front();
+      }
+      return lane == kBarrierLane ? barriers.front() : lanes[lane].front();
+    }
+
+    void push_back(Task* task) {
+      task->sequence = ++sequence;
+      if (task->isBarrier) {
+        barriers.push_back(task);
+        return;
+      }
+      if (earliestDeadlineFirst && task->deadline != kNoDeadline) {
+        if (barriers.empty()) {
+          pushDeadline(task);
+        } else {
+          deferred.push_back(task);
+        }
+        return;
+      }
+      lanes[task->priority].push_back(task);
+      nonEmptyLanes |= 1u << task->priority;
+    }
+
+    void pop_front() {
+      auto lane = select();
+      if (lane == kBarrierLane) {
+        barriers.pop_front();
+        // 进入顺序早于下一个屏障的延后任务可以入堆
+        auto* barrier = barriers.front();
+        while (!deferred.empty() &&
+               (barrier == nullptr || static_cast<int32_t>(deferred.front()->sequence - barrier->sequence) < 0)) {
+          auto* task = deferred.front();
+          deferred.pop_front();
+          pushDeadline(task);
+        }
+        return;
+      }
+
+      bool cancelled;
+      bool empty;
+      if (lane == kDeadlineLane) {
+        cancelled = deadlines.front()->cancelled;
+        std::pop_heap(deadlines.begin(), deadlines.end(), laterDeadline);
+        deadlines.pop_back();
+        deadlineCount.store(deadlines.size(), std::memory_order_relaxed);
+        empty = deadlines.empty();
+      } else {
+        cancelled = lanes[lane].front()->cancelled;
+        lanes[lane].pop_front();
+        empty = lanes[lane].empty();
+        skipped[lane] = 0;
+      }
+      if (empty) {
+        nonEmptyLanes &= ~(1u << lane);
+      }
+
+      // 更低的非空通道被抢先一次（回收墓碑不算作执行）
+      auto lower = nonEmptyLanes & ((1u << lane) - 1);
+      if (lower == 0 || cancelled) {
+        return;
+      }
+      for (size_t i = 0; i < lane; ++i) {
+        if ((lower & (1u << i)) != 0) {
+          skipped[i]++;
+        }
+      }
+    }
+
+    /// 选择队首所在的通道，返回 kDeadlineLane 表示堆顶，kBarrierLane 表示屏障
+    size_t select() const {
+      // 常见情况：只有默认优先级的任务
+      if (nonEmptyLanes == 1u << kThreadQoSClassNormal && barriers.empty()) {
+        return kThreadQoSClassNormal;
+      }
+
+      // 堆中的任务都早于最早的屏障
+      auto* barrier = barriers.front();
+      size_t top = (nonEmptyLanes & (1u << kDeadlineLane)) != 0 ? kDeadlineLane : kBarrierLane;
+      for (size_t i = kPriorityLanes; i-- > 0;) {
+        auto* head = lanes[i].front();
+        // 进入顺序晚于最早屏障的任务要等屏障执行完毕（序号可能回绕，按差值比较）
+        if (head == nullptr || (barrier != nullptr && static_cast<int32_t>(head->sequence - barrier->sequence) > 0)) {
+          continue;
+        }
+        if (top == kBarrierLane) {
+          top = i;
+        } else if (skipped[i] >= kPriorityAgingLimit) {
+          return i;
+        }
+      }
+      return top;
+    }
+
+    /// 移除最低优先级非空通道的队首（不计入老化），通道都为空时移除堆顶或延后的任务；没有时返回 nullptr
+    Task* evict() {
+      for (size_t lane = 0; lane < kPriorityLanes; ++lane) {
+        if ((nonEmptyLanes & (1u << lane)) != 0) {
+          auto* task = lanes[lane].front();
+          lanes[lane].pop_front();
+          if (lanes[lane].empty()) {
+            nonEmptyLanes &= ~(1u << lane);
+            skipped[lane] = 0;
+          }
+          return task;
+        }
+      }
+      if (!deadlines.empty()) {
+        auto* task = deadlines.front();
+        std::pop_heap(deadlines.begin(), deadlines.end(), laterDeadline);
+        deadlines.pop_back();
+        deadlineCount.store(deadlines.size(), std::memory_order_relaxed);
+        if (deadlines.empty()) {
+          nonEmptyLanes &= ~(1u << kDeadlineLane);
+        }
+        return task;
+      }
+      auto* task = deferred.front();
+      if (task != nullptr) {
+        deferred.pop_front();
+      }
+      return task;
+    }
+
+    void pushDeadline(Task* task) {
+      deadlines.push_back(task);
+      std::push_heap(deadlines.begin(), deadlines.end(), laterDeadline);
+      deadlineCount.store(deadlines.size(), std::memory_order_relaxed);
+      nonEmptyLanes |= 1u << kDeadlineLane;
+    }
+
+    /// 堆的比较函数：a 是否应排在 b 之后
+    static bool laterDeadline(const Task* a, const Task* b) {
+      if (a->deadline != b->deadline) {
+        return a->deadline > b->deadline;
+      }
+      return static_cast<int32_t>(a->sequence - b->sequence) > 0;
+    }
+  };
+
+  /**
+   * @brief 等待新任务的空闲线程
+   *
+   * 每个等待者使用自己的互斥锁和条件变量，唤醒时只通知被选中的线程，避免惊群。
+   * 唤醒分两步：持有 mutex_ 时认领（claimed），释放 mutex_ 后再通知（signalled），
+   * 被唤醒的线程不会立即阻塞在锁上。
+   * 等待者对象由队列持有并复用（直到队列析构才释放），通知方在解锁后访问它是安全的，
+   * 最坏情况只是让复用它的线程多醒来一次。
+   */
+  struct Waiter {
+    std::mutex mutex;                   ///< 保护 signalled
+    std::condition_variable condition;  ///< 等待者自己的条件变量
+    Waiter* prev = nullptr;             ///< 空闲栈中的前驱（更靠近栈顶）
+    Waiter* next = nullptr;             ///< 空闲栈中的后继
+    Waiter* nextWoken = nullptr;        ///< 待通知链表或空闲链表中的后继
+    size_t group = 0;                   ///< 等待线程的等待组
+    bool claimed = false;               ///< 是否已被认领（受 mutex_ 保护）
+    bool signalled = false;             ///< 是否已收到通知（受 Waiter::mutex 保护）
+  };
+
+  /// 无锁提交队列的容量
+  static constexpr size_t kSubmissionQueueCapacity = 256;
+
+  std::atomic_bool disposed_;                                                    ///< 队列是否已销毁
+  mutable std::mutex mutex_;                                                     ///< 保护队列的互斥锁
+  std::condition_variable condition_;                                            ///< 屏障以及并发数受限时等待的条件变量
+  std::atomic<TaskId> taskIdCounter_{0};                                         ///< 任务ID计数器
+  SubmissionQueue submissions_{kSubmissionQueueCapacity};                        ///< 无锁提交队列（立即执行的任务）
+  std::atomic<size_t> waiters_{0};                                               ///< 空闲线程数（无锁提交路径据此判断是否需要唤醒）
+  Waiter* idleWaiters_ = nullptr;                                                ///< 空闲线程栈（后进先出，优先唤醒缓存较热的线程）
+  size_t pendingWakeups_ = 0;                                                    ///< 已唤醒但尚未重新获取锁的等待者数量
+  Waiter* freeWaiters_ = nullptr;                                                ///< 可复用的等待者对象
+  Waiter* wokenWaiters_ = nullptr;                                               ///< 已认领、等待解锁后通知的等待者
+  Waiter* timerLeader_ = nullptr;                                                ///< 负责等待最早延迟任务到期的等待者
+  std::chrono::steady_clock::time_point timerLeaderDeadline_;                    ///< timerLeader_ 的等待截止时间
+  size_t conditionWaiters_ = 0;                                                  ///< 在 condition_ 上等待的线程数
+  bool interruptRequested_ = false;                                              ///< 是否有未被响应的 interruptWait() 请求
+  std::atomic_bool lockedSubmissions_{false};                                    ///< 是否所有提交都走加锁路径（设置了监听器或容量）
+  ReadyQueue tasks_;                                                             ///< 就绪任务队列（按优先级分通道，可能包含墓碑）
+  TimerWheel<Task> timers_;                                                      ///< 未到期的延迟任务
+  TaskIndex<Task> index_;                                                        ///< 任务ID索引，用于 O(1) 取消
+  SlabAllocator taskAllocator_{sizeof(Task)};                                    ///< 任务节点分配器
+  bool empty_ = true;                                                            ///< 队列是否为空
+  std::atomic_bool first_{true};                                                 ///< 是否为第一个任务
+  size_t currentRunningTasks_ = 0;                                               ///< 当前正在执行的任务数
+  size_t maxConcurrentTasks_ = 1;                                                ///< 最大并发任务数
+  std::atomic<DeadlineMissPolicy> deadlineMissPolicy_{DeadlineMissPolicy::Run};  ///< 开始时已超时的任务的处理方式
+  DeadlineStats deadlineStats_;                                                  ///< 带截止时间的任务的统计信息
+  std::atomic<size_t> capacity_{0};                                              ///< 队列容量（0 表示不限制）
+  OverflowPolicy overflowPolicy_ = OverflowPolicy::Block;                        ///< 队列已满时的处理方式
+  size_t queuedTasks_ = 0;                                                       ///< 计入容量的任务数（不含屏障、墓碑和已取出的任务）
+  size_t blockedProducers_ = 0;                                                  ///< 等待空间的生产者数量
+  std::condition_variable spaceCondition_;                                       ///< 生产者等待空间的条件变量
+  std::deque<TaskFunction> spaceCallbacks_;                                      ///< tryEnqueue 登记的腾出空间时的回调
+  OverflowStats overflowStats_;                                                  ///< 有界队列的统计信息
+  std::shared_ptr<IQueueListener> listener_;                                     ///< 队列监听器
+  size_t pendingListenerEvents_ = 0;                                             ///< 待投递的监听器事件数（空/非空交替出现）
+  bool firstListenerEventNonEmpty_ = false;                                      ///< 第一个待投递事件是否为 onQueueNonEmpty
+  bool deliveringListenerEvents_ = false;                                        ///< 是否有线程正在锁外投递监听器事件
 
   /**
    * @brief 获取下一个待执行的任务
    * @param maxTime 最大等待时间
    * @param shouldRun 输出参数，是否应该执行任务
-   * @return DispatchFunction 任务函数
+   * @param deadline 输出参数，任务的截止时间
+   * @return TaskFunction 任务函数
+   */
+  TaskFunction nextTask(std::chrono::steady_clock::time_point maxTime, bool* shouldRun,
+                        std::chrono::steady_clock::time_point* deadline);
+
+  /**
+   * @brief 在调用线程上执行一个已取出的带截止时间的任务
+   *
+   * 开始前检查是否已经超时：按 deadlineMissPolicy_ 丢弃，或者执行期间让
+   * currentTaskMissedDeadline() 返回 true。统计结果累加到 stats 中，由调用者在持有锁时合并。
+   *
+   * @param function 任务函数，返回时已被销毁
+   * @param deadline 截止时间
+   * @param stats 累加的统计信息
+   */
+  void runTaskWithDeadline(TaskFunction& function, std::chrono::steady_clock::time_point deadline,
+                           DeadlineStats* stats);
+
+  /**
+   * @brief 合并 runTaskWithDeadline() 累加的统计信息（需在持有锁时调用）
+   * @param stats 统计信息
+   */
+  void addDeadlineStats(const DeadlineStats& stats);
+
+  /**
+   * @brief 等待直到队首有可执行的任务（需在持有锁时调用）
+   * @param lock 已持有的锁
+   * @param maxTime 最大等待时间点
+   * @return true 队首任务可以执行
+   * @return false 超时或队列已销毁
+   */
+  bool waitForRunnableTask(std::unique_lock<std::mutex>& lock, std::chrono::steady_clock::time_point maxTime);
+
+  /**
+   * @brief 批量取出就绪任务
+   *
+   * 取出的节点通过 next 串联，保留在索引中以便取消，执行完成后由 runNextTasks 回收。
+   *
+   * @param maxTime 最大等待时间点
+   * @param maxBatch 一次最多取出的任务数
+   * @return Task* 取出的任务链表，超时或队列已销毁时返回 nullptr
+   */
+  Task* claimTasks(std::chrono::steady_clock::time_point maxTime, size_t maxBatch);
+
+  /**
+   * @brief 响应 interruptWait() 请求（需在持有锁时调用）
+   * @param maxTime 调用者的最大等待时间点，已经超时的调用不响应请求
+   * @return true 存在未响应的请求，调用者应停止等待并返回
+   */
+  bool consumeInterrupt(std::chrono::steady_clock::time_point maxTime);
+
+  /**
+   * @brief 作为空闲线程等待新任务（需在持有锁时调用）
+   *
+   * 压入空闲栈后再检查无锁提交队列，与 notifySubmission() 配合避免丢失唤醒。
+   *
+   * @param lock 已持有的锁
+   * @param maxTime 最大等待时间点
+   * @param timerLeader 是否作为 timer leader 等待最早的延迟任务到期
+   * @return std::cv_status 等待结果，被唤醒时返回 no_timeout
+   */
+  std::cv_status waitForWork(std::unique_lock<std::mutex>& lock, std::chrono::steady_clock::time_point maxTime,
+                             bool timerLeader);
+
+  /**
+   * @brief 在 condition_ 上等待屏障或并发数的变化（需在持有锁时调用）
+   * @param lock 已持有的锁
+   * @param maxTime 最大等待时间点
+   * @return std::cv_status 等待结果
+   */
+  std::cv_status waitForStateChange(std::unique_lock<std::mutex>& lock, std::chrono::steady_clock::time_point maxTime);
+
+  /**
+   * @brief 按就绪任务数量唤醒空闲线程（需在持有锁时调用）
+   *
+   * 唤醒数量不超过就绪任务数和剩余并发数，已唤醒但尚未运行的线程也计算在内。
+   */
+  void wakeWorkers();
+
+  /**
+   * @brief 确保有线程等待最早的延迟任务到期（需在持有锁时调用）
+   *
+   * 没有 timer leader 时唤醒一个空闲线程接任；
+   * 新任务的执行时间早于 leader 的等待截止时间时唤醒 leader 重新计算。
+   *
+   * @param executeTime 新插入的延迟任务的执行时间，为 kImmediate 时只检查是否缺少 leader
    */
-  DispatchFunction nextTask(std::chrono::steady_clock::time_point maxTime, bool* shouldRun);
+  void wakeTimerLeader(std::chrono::steady_clock::time_point executeTime);
+
+  /**
+   * @brief 认领指定的空闲线程（需在持有锁时调用）
+   *
+   * 等待者从空闲栈中移除并加入 wokenWaiters_，释放锁后由 signalWaiters() 通知。
+   *
+   * @param waiter 空闲栈中的等待者
+   */
+  void wakeWaiter(Waiter* waiter);
+
+  /**
+   * @brief 通知已认领的等待者（需在释放锁后调用）
+   * @param waiters 在持有锁时从 wokenWaiters_ 取出的链表
+   */
+  static void signalWaiters(Waiter* waiters);
+
+  /**
+   * @brief 从 wokenWaiters_ 中移除尚未被取走的等待者（需在持有锁时调用）
+   * @param waiter 已认领的等待者
+   * @return true 等待者仍在 wokenWaiters_ 中并已移除，之后不会再被通知
+   */
+  bool unlinkWoken(Waiter* waiter);
+
+  /**
+   * @brief 从空闲栈中移除等待者（需在持有锁时调用）
+   * @param waiter 空闲栈中的等待者
+   */
+  void unlinkWaiter(Waiter* waiter);
+
+  /**
+   * @brief 无锁提交后唤醒空闲线程
+   *
+   * 只有存在空闲线程时才获取互斥锁。
+   */
+  void notifySubmission();
+
+  /**
+   * @brief 将无锁提交队列中的任务移入就绪队列（需在持有锁时调用）
+   *
+   * @param waitForPending 是否等待已认领但尚未发布的槽位。
+   *                       加锁路径插入任务前需要为 true，以保证同一生产者提交的任务顺序。
+   */
+  void drainSubmissions(bool waitForPending);
+
+  /**
+   * @brief 标记队列非空并记录监听器事件（需在持有锁时调用）
+   */
+  void markNonEmpty();
+
+  /**
+   * @brief 记录一个监听器事件，等待释放锁后投递（需在持有锁时调用）
+   * @param nonEmpty true 为 onQueueNonEmpty，false 为 onQueueEmpty
+   */
+  void queueListenerEvent(bool nonEmpty);
+
+  /**
+   * @brief 是否有待投递且无人投递的监听器事件（需在持有锁时调用）
+   */
+  bool shouldDeliverListenerEvents() const;
+
+  /**
+   * @brief 按产生顺序投递监听器事件
+   *
+   * 每个回调都在释放锁后调用。同一时间只有一个线程投递，
+   * 投递期间新产生的事件（包括回调中再次提交任务产生的事件）由该线程继续投递，保证回调不重叠且顺序不变。
+   *
+   * @param lock 已持有的锁，返回时仍持有
+   */
+  void deliverListenerEvents(std::unique_lock<std::mutex>& lock);
+
+  /**
+   * @brief 获取锁并投递监听器事件（需在未持有锁时调用）
+   */
+  void deliverListenerEvents();
 
   /**
    * @brief 插入任务到队列
+   *
+   * 就绪任务追加到 tasks_ 中其优先级通道的尾部，未到期的任务放入时间轮。
+   *
+   * @param id 任务ID
    * @param function 任务函数
    * @param executeTime 执行时间
    * @param isBarrier 是否为屏障任务
+   * @param delayed 任务是否尚未到期
+   * @param priority 优先级
+   * @param deadline 截止时间（只用于就绪任务）
    * @return TaskId 任务ID
    */
-  TaskId insertTask(DispatchFunction&& function, std::chrono::steady_clock::time_point executeTime, bool isBarrier);
+  TaskId insertTask(TaskId id, TaskFunction&& function, std::chrono::steady_clock::time_point executeTime,
+                    bool isBarrier, bool delayed, ThreadQoSClass priority = kThreadQoSClassNormal,
+                    std::chrono::steady_clock::time_point deadline = kNoDeadline);
+
+  /**
+   * @brief 入队任务
+   *
+   * 立即执行、默认优先级且没有截止时间的任务优先写入无锁提交队列，其他任务加锁插入。
+   *
+   * @param function 任务函数
+   * @param executeTime 执行时间，kImmediate 表示立即执行
+   * @param priority 优先级
+   * @param deadline 截止时间，kNoDeadline 表示没有
+   * @return EnqueuedTask 包含任务ID和是否首个任务的信息
+   */
+  EnqueuedTask enqueueTask(TaskFunction&& function, std::chrono::steady_clock::time_point executeTime,
+                           ThreadQoSClass priority, std::chrono::steady_clock::time_point deadline,
+                           TaskFunction* onSpaceAvailable = nullptr);
+
+  /**
+   * @brief 为 count 个新任务预留容量（需在持有锁时调用，只在设置了容量时调用）
+   *
+   * 队列已满时：tryEnqueue（onSpaceAvailable 不为空）登记回调并拒绝；本队列的工作线程不受限制；
+   * 其他情况按 overflowPolicy_ 阻塞等待（期间释放锁）、丢弃最早的就绪任务或拒绝超出的新任务。
+   *
+   * @param lock 已持有的锁
+   * @param count 新任务数量
+   * @param onSpaceAvailable tryEnqueue 的回调，为 nullptr 时按溢出策略处理
+   * @param evicted 被丢弃的已排队任务，由调用者在锁外销毁
+   * @return size_t 可以入队的新任务数量（DropOldest 下丢弃的是靠前的新任务，其余策略丢弃靠后的）
+   */
+  size_t reserveCapacity(std::unique_lock<std::mutex>& lock, size_t count, TaskFunction* onSpaceAvailable,
+                         std::vector<TaskFunction>* evicted);
+
+  /**
+   * @brief 丢弃最早排队的就绪任务（需在持有锁时调用）
+   * @param evicted 被丢弃的任务函数追加到这里
+   * @return true 丢弃了一个任务
+   * @return false 没有可以丢弃的就绪任务
+   */
+  bool evictOldestTask(std::vector<TaskFunction>* evicted);
+
+  /**
+   * @brief 是否有等待空间的生产者或回调（需在持有锁时调用）
+   */
+  bool hasSpaceWaiters() const { return blockedProducers_ != 0 || !spaceCallbacks_.empty(); }
+
+  /**
+   * @brief 按腾出的空间唤醒阻塞的生产者并调用回调（需在未持有锁时调用）
+   */
+  void notifySpaceAvailable();
+
+  /**
+   * @brief 分配任务节点（需在持有锁时调用）
+   *
+   * 节点内存来自 taskAllocator_。
+   */
+  Task* allocateTask(TaskId id, TaskFunction&& function, std::chrono::steady_clock::time_point executeTime,
+                     bool isBarrier);
+
+  /**
+   * @brief 回收任务节点（需在持有锁时调用）
+   *
+   * 销毁节点并将内存归还给 taskAllocator_。节点的任务函数必须已被移走或为空。
+   */
+  void releaseTask(Task* task);
+
+  /**
+   * @brief 回收就绪队列头部的墓碑节点（需在持有锁时调用）
+   */
+  void purgeCancelledTasks();
+
+  /**
+   * @brief 将时间轮中已到期的任务批量移入就绪队列（需在持有锁时调用）
+   * @param now 当前时间
+   */
+  void promoteExpiredTimers(std::chrono::steady_clock::time_point now);
 
   /**
    * @brief 移除任务（无锁版本，需在持有锁时调用）
+   *
+   * 通过索引 O(1) 定位任务：时间轮中的任务直接摘除，
+   * 就绪队列中的任务标记为墓碑，等到达队首时再回收节点。
+   *
    * @param taskId 任务ID
-   * @return DispatchFunction 被移除的任务函数
+   * @return TaskFunction 被移除的任务函数
    */
-  DispatchFunction lockFreeRemoveTask(TaskId taskId);
+  TaskFunction lockFreeRemoveTask(TaskId taskId);
 };
 
 }  // namespace dispatch
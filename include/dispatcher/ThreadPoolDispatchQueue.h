@@ -3,22 +3,69 @@
  * @brief 线程池调度队列
  *
  * 使用线程池实现的调度队列，支持真正的并发任务执行。
- * 通过多个工作线程同时从 TaskQueue 中获取和执行任务。
+ * 每个工作线程拥有本地的工作窃取队列，外部提交的任务经由共享的 TaskQueue（全局注入队列）分发。
  */
 
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "CpuTopology.h"
 #include "DispatchQueue.h"
 #include "TaskQueue.h"
+#include "ThreadQoS.h"
+#include "WorkStealingDeque.h"
 
 namespace dispatch {
 
+/**
+ * @brief 线程池配置
+ *
+ * minThreads == maxThreads 时为固定大小的线程池；否则线程池在两者之间按负载伸缩：
+ * - 没有空闲线程且等待执行的任务数达到 spawnBacklog，或这种状态持续超过 spawnLatency 时，创建新线程
+ * - 空闲超过 idleTimeout 的线程在线程数多于 minThreads 时退出
+ *
+ * CPU 绑定（仅 Linux）：
+ * - placement 为 Spread/Pack 时，按 CpuTopology::layout() 的顺序将第 i 个工作线程绑定到一个 CPU
+ * - placement 为 None 且 cpus 非空时，所有工作线程绑定到整个 cpus 集合
+ * - numaQueues 为 true 且绑定后的线程分布在多个 NUMA 节点上时，外部线程提交的立即任务进入提交者所在节点的子队列，
+ *   优先由该节点的工作线程执行，该节点的线程都在忙时再由其他节点的空闲线程执行
+ *
+ * qosClass 在每个工作线程启动时应用（见 ThreadQoS），之后可以通过 setQoSClass() 修改。
+ */
+struct ThreadPoolOptions {
+  size_t minThreads = 1;                                                            ///< 最少线程数（启动时创建），至少为1
+  size_t maxThreads = 1;                                                            ///< 最多线程数
+  std::chrono::steady_clock::duration idleTimeout = std::chrono::seconds(10);       ///< 多余线程的空闲超时
+  size_t spawnBacklog = 8;                                                          ///< 触发扩容的积压任务数
+  std::chrono::steady_clock::duration spawnLatency = std::chrono::milliseconds(1);  ///< 触发扩容的积压持续时间
+  WorkerPlacement placement = WorkerPlacement::None;                                ///< 工作线程的 CPU 布局方式
+  std::vector<int> cpus;                                                            ///< 允许使用的 CPU，为空时使用创建者当前允许的 CPU
+  bool numaQueues = false;                                                          ///< 是否为每个 NUMA 节点使用独立的子队列
+  ThreadQoSClass qosClass = kThreadQoSClassNormal;                                  ///< 工作线程的服务质量等级
+};
+
+/**
+ * @brief 线程池的运行统计
+ */
+struct ThreadPoolStats {
+  size_t threads = 0;      ///< 当前线程数
+  size_t idleThreads = 0;  ///< 当前空闲（等待任务）的线程数
+  uint64_t spawned = 0;    ///< 累计创建的线程数（包括启动时创建的）
+  uint64_t retired = 0;    ///< 累计因空闲超时退出的线程数
+};
+
 /**
  * @brief 线程池调度队列
  *
@@ -31,7 +78,33 @@ namespace dispatch {
  * - I/O密集型任务的并发处理
  * - 需要限制并发数的任务调度
  *
+ * 调度方式（工作窃取）：
+ * - 工作线程内提交的立即任务放入该线程的 next 槽位，当前任务结束后由本线程接着执行（缓存较热）；
+ *   槽位原有的任务挤入本地队列，拥有者按后进先出执行，空闲线程从其他线程的本地队列头部按先进先出窃取
+ * - 本地队列都为空时，空闲线程先让出一次 CPU 再取走其他线程 next 槽位中的任务，
+ *   提交后阻塞等待子任务的任务不会因此停顿；连续从槽位执行 kMaxConsecutiveNextRuns 次后先执行本地队列
+ * - 外部线程提交的任务、延迟任务和批量延迟任务进入全局的 TaskQueue，空闲线程在其上等待
+ * - 工作线程优先执行本地任务，其次窃取，最后才访问全局队列；每执行 kGlobalQueueInterval 次
+ *   也会检查一次全局队列，避免全局任务和到期的延迟任务饥饿
+ * - 指定了优先级的任务进入全局队列的优先级通道；全局队列中有高于默认优先级的就绪任务时，
+ *   工作线程每轮都先检查全局队列
+ * - 本地队列有任务而存在空闲线程时，通过 TaskQueue::interruptWait() 唤醒一个线程窃取，
+ *   同一时刻最多只有一个这样的唤醒请求，窃取成功的线程再按需唤醒下一个
+ * - sync() 等待全局和本地的所有任务完成后再执行；等待期间工作线程提交的任务进入全局队列，排在屏障之后
+ *
+ * NUMA 感知（见 ThreadPoolOptions）：
+ * - 绑定了 CPU 的工作线程先从同一节点的线程窃取，再从其他节点窃取
+ * - 启用子队列时，工作线程依次检查：本地队列 -> 本节点子队列 -> 窃取 -> 其他节点子队列；
+ *   唤醒空闲线程时优先选择同一节点的线程（TaskQueue::interruptWait(group)）
+ *
+ * 弹性伸缩（见 ThreadPoolOptions）：
+ * - 每个可能的线程（maxThreads 个）预先分配本地状态槽位，线程创建和退出时占用和释放槽位
+ * - 提交任务和工作线程定期检查全局队列时评估积压情况，满足条件时在当前线程中创建新线程，
+ *   新线程开始运行之前不会再次扩容
+ * - 只有本地队列为空且没有积压任务时，空闲超时的线程才会退出
+ *
  * @note 任务之间没有顺序保证，如需顺序执行请使用 ThreadedDispatchQueue
+ * @note 本地队列中的任务不可取消，队列监听器只反映全局队列的状态
  */
 class ThreadPoolDispatchQueue : public DispatchQueue {
  public:
@@ -50,25 +123,144 @@ class ThreadPoolDispatchQueue : public DispatchQueue {
    */
   static std::shared_ptr<ThreadPoolDispatchQueue> create(const std::string& name);
 
+  /**
+   * @brief 创建可伸缩的线程池调度队列
+   * @param name 队列名称
+   * @param options 线程数配置
+   * @return std::shared_ptr<ThreadPoolDispatchQueue> 队列实例
+   */
+  static std::shared_ptr<ThreadPoolDispatchQueue> create(const std::string& name, const ThreadPoolOptions& options);
+
   ~ThreadPoolDispatchQueue() override;
 
-  // IDispatchQueue 接口实现
-  void sync(const DispatchFunction& function) override;
-  void async(DispatchFunction function) override;
-  TaskId asyncAfter(DispatchFunction function, std::chrono::steady_clock::duration delay) override;
+  // IDispatchQueue 接口实现（保留接受 DispatchGroup 的重载）
+  using IDispatchQueue::async;
+  using IDispatchQueue::asyncAfter;
+  using IDispatchQueue::asyncWithDeadline;
+  void sync(const TaskFunction& function) override;
+  void async(TaskFunction function) override;
+  TaskId asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay) override;
+  void asyncBatch(std::vector<TaskFunction> functions) override;
+  TaskId asyncBatchAfter(std::vector<TaskFunction> functions, std::chrono::steady_clock::duration delay) override;
   void cancel(TaskId taskId) override;
 
+  /**
+   * @brief 按优先级异步执行任务
+   *
+   * 非默认优先级的任务总是进入全局队列的对应通道（不进入本地队列）；
+   * 全局队列中有高于默认优先级的任务时，工作线程先执行它们，再执行本地任务。
+   * @param function 任务函数
+   * @param priority 任务优先级
+   */
+  void async(TaskFunction function, ThreadQoSClass priority) override;
+
+  /**
+   * @brief 按优先级延迟异步执行任务（到期后进入全局队列的对应通道）
+   * @param function 任务函数
+   * @param delay 延迟时间
+   * @param priority 任务优先级
+   * @return TaskId 任务ID
+   */
+  TaskId asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay,
+                    ThreadQoSClass priority) override;
+
+  /**
+   * @brief 异步执行需要在截止时间前完成的任务
+   *
+   * 任务总是进入全局队列；EDF 策略下工作线程先执行全局队列中带截止时间的任务，再执行本地任务。
+   * @param function 任务函数
+   * @param deadline 从现在起的完成期限
+   */
+  void asyncWithDeadline(TaskFunction function, std::chrono::steady_clock::duration deadline) override;
+
+  /**
+   * @brief 尝试异步执行任务，全局队列已满时立即返回 false
+   *
+   * 工作线程内提交时进入本地队列，总是成功。
+   * @param function 任务函数，返回 false 时保持不变
+   * @return true 已提交
+   */
+  bool tryAsync(TaskFunction&& function) override;
+
+  /**
+   * @brief 尝试异步执行任务，全局队列已满时登记腾出空间时的回调
+   * @param function 任务函数，返回 false 时保持不变
+   * @param onSpaceAvailable 腾出空间时的回调（在工作线程上调用）
+   * @return true 已提交
+   */
+  bool tryAsync(TaskFunction&& function, TaskFunction onSpaceAvailable) override;
+
+  /**
+   * @brief 并行执行区间 [begin, end) 上的循环，所有迭代完成后返回
+   *
+   * - 调用线程参与执行而不是阻塞等待；线程池只收到每个线程一个辅助任务，而不是每个块一个
+   * - 块大小自适应（guided self-scheduling）：每次从共享游标取走剩余迭代的 1/(2P)（P 为参与线程数），
+   *   不小于最小块大小；开始时块大、开销低，接近结束时块小、负载均衡
+   * - body 按模板参数内联到块循环中，每次迭代没有 std::function 调用或内存分配
+   * - 可以在工作线程中嵌套调用，辅助任务进入本地队列
+   *
+   * @tparam Index 整数类型
+   * @tparam Body 可调用对象，签名为 void(Index)，会被多个线程并发调用，不应抛出异常
+   * @param begin 起始下标
+   * @param end 结束下标（不包含）
+   * @param body 循环体
+   */
+  template <typename Index, typename Body>
+  void parallelFor(Index begin, Index end, Body&& body) {
+    parallelFor(begin, end, 0, std::forward<Body>(body));
+  }
+
+  /**
+   * @brief 并行执行区间 [begin, end) 上的循环，指定最小块大小
+   * @param begin 起始下标
+   * @param end 结束下标（不包含）
+   * @param grain 最小块大小，0 表示按迭代数和线程数自动选择
+   * @param body 循环体，签名为 void(Index)
+   */
+  template <typename Index, typename Body>
+  void parallelFor(Index begin, Index end, size_t grain, Body&& body);
+
   // DispatchQueue 接口实现
   bool isCurrent() const override;
   void fullTeardown() override;
   void setListener(const std::shared_ptr<IQueueListener>& listener) override;
   std::shared_ptr<IQueueListener> getListener() const override;
 
+  // 截止时间的调度策略、错过策略和统计作用于全局队列（带截止时间的任务都在其中）
+  void setSchedulingPolicy(SchedulingPolicy policy) override;
+  void setDeadlineMissPolicy(DeadlineMissPolicy policy) override;
+  DeadlineStats deadlineStats() const override;
+
+  // 容量限制全局队列：设置容量后外部线程提交的任务都进入全局队列（不使用 NUMA 子队列），
+  // 工作线程提交的任务进入本地队列或不受限制地进入全局队列
+  void setCapacity(size_t capacity, OverflowPolicy policy = OverflowPolicy::Block) override;
+  OverflowStats overflowStats() const override;
+
+  /**
+   * @brief 设置工作线程的服务质量等级
+   *
+   * 立即应用到所有运行中的工作线程，之后创建的线程也使用新的等级。
+   * @param qosClass 服务质量等级
+   */
+  void setQoSClass(ThreadQoSClass qosClass) override;
+
   /**
-   * @brief 获取工作线程数量
+   * @brief 获取当前的工作线程数量
    * @return size_t 线程数量
    */
-  size_t threadCount() const { return thread_count_; }
+  size_t threadCount() const { return thread_count_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 获取线程数配置
+   * @return const ThreadPoolOptions& 配置
+   */
+  const ThreadPoolOptions& options() const { return options_; }
+
+  /**
+   * @brief 获取线程数和线程创建、退出次数的统计信息
+   * @return ThreadPoolStats 统计信息
+   */
+  ThreadPoolStats stats() const;
 
   /**
    * @brief 获取队列名称
@@ -76,25 +268,243 @@ class ThreadPoolDispatchQueue : public DispatchQueue {
    */
   const std::string& name() const { return name_; }
 
+  /**
+   * @brief 获取任务节点分配器的统计信息
+   * @return AllocatorStats 统计信息
+   */
+  AllocatorStats allocatorStats() const { return task_queue_.allocatorStats(); }
+
  private:
-  ThreadPoolDispatchQueue(const std::string& name, size_t threadCount);
+  ThreadPoolDispatchQueue(const std::string& name, const ThreadPoolOptions& options);
 
   /**
-   * @brief 启动所有工作线程
+   * @brief 启动 minThreads 个工作线程
    */
   void start();
 
+  /// 本地队列中的任务（定义见实现文件）
+  struct LocalTask;
+
+  /// parallelFor 的共享状态（定义见实现文件）
+  struct ParallelForState;
+
+  /// parallelFor 执行一个块的函数：run(body, first, last) 执行偏移 [first, last) 上的迭代
+  using ParallelForChunk = void (*)(void* body, size_t first, size_t last);
+
+  /**
+   * @brief parallelFor 的非模板部分：分发辅助任务，调用线程参与执行并等待所有迭代完成
+   * @param count 迭代数
+   * @param grain 最小块大小，0 表示自动选择
+   * @param body 类型擦除后的循环体
+   * @param run 执行一个块的函数
+   */
+  void runParallelFor(size_t count, size_t grain, void* body, ParallelForChunk run);
+
+  /**
+   * @brief 工作线程的本地状态
+   */
+  struct Worker {
+    std::atomic<LocalTask*> next{nullptr};                    ///< 最近提交的任务（LIFO 槽位）
+    size_t nextRuns = 0;                                      ///< 连续从 next 执行的次数（仅拥有者访问）
+    WorkStealingDeque<LocalTask> deque{kLocalQueueCapacity};  ///< 本地任务队列
+    size_t tick = 0;                                          ///< 调度轮数（仅拥有者访问）
+    int cpu = -1;                                             ///< 绑定的 CPU，-1 表示不绑定单个 CPU
+    size_t node = 0;                                          ///< 所在的 NUMA 节点序号
+    std::thread thread;                                       ///< 占用该槽位的线程（受 spawn_mutex_ 保护）
+    bool active = false;                                      ///< 槽位是否被线程占用（受 spawn_mutex_ 保护）
+    ThreadQoS::NativeId threadId = 0;                         ///< 运行中线程的 ID，0 表示没有（受 qos_mutex_ 保护）
+  };
+
+  /**
+   * @brief NUMA 节点的子队列（外部线程提交的立即任务）
+   */
+  struct NodeQueue {
+    std::mutex mutex;              ///< 保护 tasks
+    std::deque<LocalTask*> tasks;  ///< 等待执行的任务（先进先出）
+    std::atomic<size_t> size{0};   ///< 任务数量，用于无锁判空
+  };
+
+  /// 每个工作线程本地队列的容量，满时将一半任务批量移入全局队列
+  static constexpr size_t kLocalQueueCapacity = 256;
+
+  /// 连续从 next 槽位执行的次数上限，超过后先执行本地队列中的任务，避免互相提交的任务使其饥饿
+  static constexpr size_t kMaxConsecutiveNextRuns = 3;
+
+  /// 优先执行本地任务时，每隔多少轮检查一次全局队列
+  static constexpr size_t kGlobalQueueInterval = 61;
+
   /**
    * @brief 工作线程主循环
-   * @param threadIndex 线程索引（用于调试）
+   * @param threadIndex 线程索引，对应 local_workers_ 中的本地状态
    */
   void workerMain(size_t threadIndex);
 
-  std::string name_;                                   ///< 队列名称
-  size_t thread_count_;                                ///< 工作线程数量
-  TaskQueue task_queue_;                               ///< 任务队列
-  std::vector<std::unique_ptr<std::thread>> workers_;  ///< 工作线程列表
-  std::atomic<bool> running_{false};                   ///< 运行状态标志
+  /**
+   * @brief 在空闲槽位上创建一个工作线程
+   * @return true 创建成功；已停止或已达到 maxThreads 时返回 false
+   */
+  bool spawnWorker();
+
+  /**
+   * @brief 没有空闲线程且任务积压时按需创建新线程
+   */
+  void maybeGrow();
+
+  /**
+   * @brief 空闲超时后尝试退出当前线程
+   * @param worker 当前线程的槽位，退出时与减少线程数在同一临界区内释放
+   * @return true 线程数已减少、槽位已释放，当前线程应当退出
+   */
+  bool tryRetire(Worker& worker);
+
+  /**
+   * @brief 尝试将任务放入当前工作线程的 next 槽位
+   *
+   * 只有在本线程池的工作线程中、且没有等待中的 sync() 时才使用本地队列。
+   * 槽位中原有的任务被挤入本地队列，供其他线程窃取。
+   *
+   * @param function 任务函数，仅在成功时被移走
+   * @return true 已压入本地队列
+   */
+  bool pushLocal(TaskFunction& function);
+
+  /**
+   * @brief 尝试将外部线程提交的任务放入提交者所在 NUMA 节点的子队列
+   *
+   * 只有启用了子队列、不在本线程池的工作线程中、且没有等待中的 sync() 时才使用子队列。
+   *
+   * @param functions 任务函数数组，仅在成功时被移走
+   * @param count 任务数量
+   * @return true 已放入子队列
+   */
+  bool pushNodeQueue(TaskFunction* functions, size_t count);
+
+  /**
+   * @brief 从 NUMA 节点的子队列取出一个任务并执行
+   * @param node 节点序号
+   * @return true 执行了任务
+   */
+  bool runNodeTask(size_t node);
+
+  /**
+   * @brief 依次尝试其他 NUMA 节点的子队列（当前节点的线程空闲时帮助繁忙的节点）
+   * @param node 当前线程所在的节点序号
+   * @return true 执行了任务
+   */
+  bool runRemoteNodeTask(size_t node);
+
+  /**
+   * @brief 本地队列已满时，将一半的本地任务和新任务批量移入全局队列
+   * @param deque 当前线程的本地队列
+   * @param task 未能压入的新任务
+   */
+  void spillLocalTasks(WorkStealingDeque<LocalTask>& deque, LocalTask* task);
+
+  /**
+   * @brief 执行 next 槽位或本地队列中最近提交的任务
+   * @return true 执行了任务
+   */
+  bool runLocalTask(Worker& worker);
+
+  /**
+   * @brief 从其他工作线程的本地队列窃取一个任务并执行
+   * @param threadIndex 当前线程索引
+   * @return true 执行了任务
+   */
+  bool stealTask(size_t threadIndex);
+
+  /**
+   * @brief 所有本地队列都为空时，取走其他工作线程 next 槽位中的任务并执行
+   *
+   * 先让出一次 CPU，给正在运行的拥有者机会自己执行该任务（缓存较热）；
+   * 拥有者阻塞等待该任务时，由窃取者执行，避免任务滞留。
+   *
+   * @param threadIndex 当前线程索引
+   * @return true 执行了任务
+   */
+  bool stealNextTask(size_t threadIndex);
+
+  /**
+   * @brief 执行并回收本地任务
+   */
+  void runLocal(LocalTask* task);
+
+  /**
+   * @brief 本地队列或子队列有新任务时，按需唤醒一个空闲线程来执行
+   * @param node 任务所在的 NUMA 节点，优先唤醒该节点的线程
+   */
+  void notifyLocalWork(size_t node);
+
+  /**
+   * @brief 检查是否有任何本地队列或子队列非空
+   */
+  bool hasLocalTasks() const;
+
+  /**
+   * @brief 统计所有本地队列和子队列中等待执行的任务数（近似值）
+   */
+  size_t localBacklog() const;
+
+  /**
+   * @brief 等待所有本地任务执行完成（由 sync() 的屏障函数调用）
+   */
+  void waitForLocalTasks();
+
+  /**
+   * @brief 回收工作线程退出后本地队列和子队列中剩余的任务（不执行）
+   */
+  void releaseLocalTasks();
+
+  /**
+   * @brief 停止并等待所有工作线程
+   */
+  void stop();
+
+  std::string name_;                                     ///< 队列名称
+  ThreadPoolOptions options_;                            ///< 线程数配置
+  TaskQueue task_queue_;                                 ///< 全局任务队列
+  std::vector<std::unique_ptr<Worker>> local_workers_;   ///< 工作线程槽位（maxThreads 个）
+  CpuTopology topology_;                                 ///< CPU 拓扑（仅在绑定 CPU 时读取）
+  size_t node_count_ = 1;                                ///< 工作线程分布的 NUMA 节点数量
+  std::vector<std::unique_ptr<NodeQueue>> node_queues_;  ///< 每个 NUMA 节点的子队列（未启用时为空）
+  std::atomic<bool> running_{false};                     ///< 运行状态标志
+  std::atomic<size_t> thread_count_{0};                  ///< 当前线程数
+  std::atomic<size_t> slot_limit_{0};                    ///< 曾被占用过的槽位上界，窃取只扫描此范围
+  std::atomic<size_t> starting_threads_{0};              ///< 已创建但尚未开始运行的线程数
+  std::atomic<int64_t> saturated_since_{0};              ///< 开始出现积压且没有空闲线程的时间（纳秒），0 表示没有
+  std::atomic<uint64_t> spawned_count_{0};               ///< 累计创建的线程数
+  std::atomic<uint64_t> retired_count_{0};               ///< 累计退出的线程数
+  std::mutex spawn_mutex_;                               ///< 保护槽位的线程对象和占用状态
+  std::atomic<size_t> local_pending_{0};                 ///< 本地队列中未完成的任务数（包括正在执行的）
+  std::atomic<size_t> parked_workers_{0};                ///< 在全局队列上等待的线程数
+  std::atomic<bool> wake_pending_{false};                ///< 是否有尚未被响应的窃取唤醒请求
+  std::atomic<size_t> barrier_count_{0};                 ///< 等待中的 sync() 数量
+  std::mutex local_mutex_;                               ///< 保护 local_drained_ 的互斥锁
+  std::condition_variable local_drained_;                ///< 本地任务全部完成时通知 sync()
+  std::mutex qos_mutex_;                                 ///< 保护 qos_class_ 和各槽位的 threadId
+  ThreadQoSClass qos_class_;                             ///< 工作线程的服务质量等级
 };
 
+template <typename Index, typename Body>
+void ThreadPoolDispatchQueue::parallelFor(Index begin, Index end, size_t grain, Body&& body) {
+  static_assert(std::is_integral<Index>::value, "parallelFor requires an integral index type");
+  if (!(begin < end)) {
+    return;
+  }
+
+  using BodyType = std::remove_reference_t<Body>;
+  struct Context {
+    BodyType* body;  ///< 循环体
+    Index begin;     ///< 起始下标
+  };
+  Context context{&body, begin};
+
+  runParallelFor(static_cast<size_t>(end - begin), grain, &context, [](void* data, size_t first, size_t last) {
+    auto* context = static_cast<Context*>(data);
+    for (size_t i = first; i < last; ++i) {
+      (*context->body)(static_cast<Index>(context->begin + static_cast<Index>(i)));
+    }
+  });
+}
+
 }  // namespace dispatch
@@ -0,0 +1,108 @@
+/**
+ * @file ThreadQoS.h
+ * @brief 线程服务质量等级与操作系统调度策略
+ *
+ * 将 ThreadQoSClass 映射为 Linux 的调度策略和 nice 值，由 ThreadedDispatchQueue 和
+ * ThreadPoolDispatchQueue 在工作线程启动时以及 setQoSClass() 时应用。
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace dispatch {
+
+/**
+ * @brief 线程服务质量等级
+ *
+ * 用于指定队列工作线程的优先级。
+ * 注意：实际效果取决于操作系统支持。
+ */
+enum ThreadQoSClass : uint8_t {
+  kThreadQoSClassLowest = 0,  ///< 最低优先级，适用于后台任务
+  kThreadQoSClassLow = 1,     ///< 低优先级，适用于不紧急的任务
+  kThreadQoSClassNormal = 2,  ///< 普通优先级，默认选择
+  kThreadQoSClassHigh = 3,    ///< 高优先级，适用于用户交互相关任务
+  kThreadQoSClassMax = 4      ///< 最高优先级，适用于实时任务
+};
+
+/**
+ * @brief kThreadQoSClassMax 使用的实时调度策略
+ */
+enum class RealtimePolicy {
+  None,        ///< 不使用实时调度，使用最小的 nice 值
+  Fifo,        ///< SCHED_FIFO
+  RoundRobin,  ///< SCHED_RR
+};
+
+/**
+ * @brief 服务质量等级的进程级配置
+ */
+struct ThreadQoSConfig {
+  RealtimePolicy realtimePolicy = RealtimePolicy::None;  ///< kThreadQoSClassMax 的实时调度策略
+  int realtimePriority = 1;                              ///< 实时调度优先级（sched_priority，1-99）
+};
+
+/**
+ * @brief 服务质量等级到调度策略的映射
+ *
+ * Linux 上的映射（其他平台为空操作）：
+ * | 等级   | 调度策略                                   | nice |
+ * |--------|--------------------------------------------|------|
+ * | Lowest | SCHED_IDLE                                 | 19   |
+ * | Low    | SCHED_BATCH                                | 10   |
+ * | Normal | SCHED_OTHER                                | 0    |
+ * | High   | SCHED_OTHER                                | -5   |
+ * | Max    | SCHED_OTHER，或按配置使用 SCHED_FIFO/SCHED_RR | -10  |
+ *
+ * 调度策略和 nice 值都是线程级的，通过线程 ID 设置，因此可以修改正在运行的其他线程。
+ * 提高优先级（负的 nice 值、实时调度，以及普通用户把已降低的 nice 值改回去）需要
+ * CAP_SYS_NICE 或足够的 RLIMIT_NICE/RLIMIT_RTPRIO，失败时保持线程原有的调度设置。
+ */
+class ThreadQoS {
+ public:
+  /// 线程标识（Linux 上为内核线程 ID，其他平台为 0）
+  using NativeId = int64_t;
+
+  /**
+   * @brief 获取调用线程的标识
+   * @return NativeId 线程标识
+   */
+  static NativeId currentThreadId();
+
+  /**
+   * @brief 将服务质量等级应用到线程
+   * @param thread 线程标识（currentThreadId() 的返回值）
+   * @param qosClass 服务质量等级
+   * @return true 调度策略和 nice 值都设置成功
+   */
+  static bool apply(NativeId thread, ThreadQoSClass qosClass);
+
+  /**
+   * @brief 将服务质量等级应用到调用线程
+   * @param qosClass 服务质量等级
+   * @return true 设置成功
+   */
+  static bool applyToCurrentThread(ThreadQoSClass qosClass) { return apply(currentThreadId(), qosClass); }
+
+  /**
+   * @brief 设置进程级配置（之后的 apply() 生效，已设置的线程不变）
+   * @param config 配置
+   */
+  static void setConfig(const ThreadQoSConfig& config);
+
+  /**
+   * @brief 获取进程级配置
+   * @return ThreadQoSConfig 配置
+   */
+  static ThreadQoSConfig config();
+
+  /**
+   * @brief 获取服务质量等级对应的 nice 值
+   * @param qosClass 服务质量等级
+   * @return int nice 值
+   */
+  static int niceValue(ThreadQoSClass qosClass);
+};
+
+}  // namespace dispatch
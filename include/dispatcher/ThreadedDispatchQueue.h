@@ -8,7 +8,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -16,9 +18,23 @@
 
 #include "DispatchQueue.h"
 #include "TaskQueue.h"
+#include "ThreadQoS.h"
 
 namespace dispatch {
 
+/**
+ * @brief 工作线程的统计信息
+ *
+ * 各字段分别读取，只是瞬时值，适合用作监控指标。
+ */
+struct ThreadStats {
+  uint64_t threadStarts = 0;       ///< 工作线程启动次数（包括空闲退出后的重新启动）
+  uint64_t threadRetirements = 0;  ///< 工作线程因空闲超时退出的次数
+  bool threadRunning = false;      ///< 当前是否有工作线程
+  size_t stackBytes = 0;           ///< 工作线程的栈大小（没有工作线程时为 0，仅 Linux 可用）
+  size_t nodeBytesRetained = 0;    ///< 任务节点分配器持有的内存
+};
+
 /**
  * @brief 线程化调度队列
  *
@@ -32,7 +48,8 @@ namespace dispatch {
  * 工作原理：
  * 1. 第一个任务入队时创建工作线程
  * 2. 工作线程循环从 TaskQueue 获取并执行任务
- * 3. 队列销毁时等待线程结束
+ * 3. 设置了空闲超时时，队列为空超过超时时间后线程退出，下一个入队的任务重新创建线程
+ * 4. 队列销毁时等待线程结束
  */
 class ThreadedDispatchQueue : public DispatchQueue {
  public:
@@ -54,13 +71,18 @@ class ThreadedDispatchQueue : public DispatchQueue {
    * @param function 要执行的任务
    * @warning 不要在队列的工作线程中调用，会导致死锁
    */
-  void sync(const DispatchFunction& function) final;
+  void sync(const TaskFunction& function) final;
+
+  // 保留 IDispatchQueue 中接受 DispatchGroup 的重载
+  using IDispatchQueue::async;
+  using IDispatchQueue::asyncAfter;
+  using IDispatchQueue::asyncWithDeadline;
 
   /**
    * @brief 异步执行任务
    * @param function 要执行的任务
    */
-  void async(DispatchFunction function) override;
+  void async(TaskFunction function) override;
 
   /**
    * @brief 延迟异步执行任务
@@ -68,7 +90,60 @@ class ThreadedDispatchQueue : public DispatchQueue {
    * @param delay 延迟时间
    * @return TaskId 任务ID，可用于取消
    */
-  TaskId asyncAfter(DispatchFunction function, std::chrono::steady_clock::duration delay) override;
+  TaskId asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay) override;
+
+  /**
+   * @brief 按优先级异步执行任务（先于已排队的较低优先级任务执行）
+   * @param function 要执行的任务
+   * @param priority 任务优先级
+   */
+  void async(TaskFunction function, ThreadQoSClass priority) override;
+
+  /**
+   * @brief 按优先级延迟异步执行任务
+   * @param function 要执行的任务
+   * @param delay 延迟时间
+   * @param priority 任务优先级
+   * @return TaskId 任务ID，可用于取消
+   */
+  TaskId asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay,
+                    ThreadQoSClass priority) override;
+
+  /**
+   * @brief 异步执行需要在截止时间前完成的任务
+   * @param function 要执行的任务
+   * @param deadline 从现在起的完成期限
+   */
+  void asyncWithDeadline(TaskFunction function, std::chrono::steady_clock::duration deadline) override;
+
+  /**
+   * @brief 尝试异步执行任务，队列已满时立即返回 false
+   * @param function 要执行的任务，返回 false 时保持不变
+   * @return true 已提交
+   */
+  bool tryAsync(TaskFunction&& function) override;
+
+  /**
+   * @brief 尝试异步执行任务，队列已满时登记腾出空间时的回调
+   * @param function 要执行的任务，返回 false 时保持不变
+   * @param onSpaceAvailable 腾出空间时的回调（在工作线程上调用）
+   * @return true 已提交
+   */
+  bool tryAsync(TaskFunction&& function, TaskFunction onSpaceAvailable) override;
+
+  /**
+   * @brief 批量异步执行任务
+   * @param functions 要执行的任务
+   */
+  void asyncBatch(std::vector<TaskFunction> functions) override;
+
+  /**
+   * @brief 批量延迟异步执行任务
+   * @param functions 要执行的任务
+   * @param delay 延迟时间
+   * @return TaskId 第一个任务的ID，其余任务的ID依次加一
+   */
+  TaskId asyncBatchAfter(std::vector<TaskFunction> functions, std::chrono::steady_clock::duration delay) override;
 
   /**
    * @brief 取消任务
@@ -99,6 +174,60 @@ class ThreadedDispatchQueue : public DispatchQueue {
    */
   bool hasThreadRunning() const;
 
+  /**
+   * @brief 获取任务节点分配器的统计信息
+   * @return AllocatorStats 统计信息
+   */
+  AllocatorStats allocatorStats() const;
+
+  /**
+   * @brief 设置工作线程的空闲超时
+   *
+   * 队列为空（包括没有延迟任务）超过 idleTimeout 后工作线程退出，释放线程栈；
+   * 下一个入队的任务重新启动线程。isCurrent()、getCurrent() 和 sync() 的语义不受影响。
+   * 零（默认）表示线程一直保留到队列销毁。
+   *
+   * @param idleTimeout 空闲超时
+   */
+  void setIdleTimeout(std::chrono::steady_clock::duration idleTimeout) override;
+
+  /**
+   * @brief 获取工作线程的统计信息（启动/退出次数、线程栈和节点内存）
+   * @return ThreadStats 统计信息
+   */
+  ThreadStats threadStats() const;
+
+  /**
+   * @brief 设置就绪任务的调度策略
+   * @param policy 调度策略
+   */
+  void setSchedulingPolicy(SchedulingPolicy policy) override;
+
+  /**
+   * @brief 设置开始执行时已超过截止时间的任务的处理方式
+   * @param policy 错过截止时间的处理方式
+   */
+  void setDeadlineMissPolicy(DeadlineMissPolicy policy) override;
+
+  /**
+   * @brief 获取带截止时间的任务的统计信息
+   * @return DeadlineStats 统计信息
+   */
+  DeadlineStats deadlineStats() const override;
+
+  /**
+   * @brief 设置队列容量和溢出策略（工作线程向本队列提交时不受限制）
+   * @param capacity 容量，0 表示不限制
+   * @param policy 溢出策略
+   */
+  void setCapacity(size_t capacity, OverflowPolicy policy = OverflowPolicy::Block) override;
+
+  /**
+   * @brief 获取有界队列的统计信息
+   * @return OverflowStats 统计信息
+   */
+  OverflowStats overflowStats() const override;
+
   /**
    * @brief 设置队列监听器
    * @param listener 监听器对象
@@ -107,6 +236,8 @@ class ThreadedDispatchQueue : public DispatchQueue {
 
   /**
    * @brief 设置线程服务质量等级
+   *
+   * 立即应用到运行中的工作线程，并在之后启动的工作线程上生效（Linux，见 ThreadQoS）。
    * @param qosClass 服务质量等级
    */
   void setQoSClass(ThreadQoSClass qosClass) final;
@@ -127,12 +258,18 @@ class ThreadedDispatchQueue : public DispatchQueue {
   void setDisableSyncCallsInCallingThread(bool disableSyncCallsInCallingThread) override;
 
  private:
-  mutable std::mutex mutex_;                      ///< 保护成员变量的互斥锁
-  std::unique_ptr<std::thread> thread_;           ///< 工作线程
-  std::shared_ptr<TaskQueue> taskQueue_;          ///< 内部任务队列
-  std::string name_;                              ///< 队列名称
-  ThreadQoSClass qosClass_;                       ///< 线程服务质量等级
-  bool disableSyncCallsInCallingThread_ = false;  ///< 是否禁用在调用线程中执行同步任务
+  mutable std::mutex mutex_;                                    ///< 保护成员变量的互斥锁
+  std::unique_ptr<std::thread> thread_;                         ///< 工作线程
+  std::shared_ptr<TaskQueue> taskQueue_;                        ///< 内部任务队列
+  std::string name_;                                            ///< 队列名称
+  std::mutex qosMutex_;                                         ///< 保护 qosClass_ 和 threadId_ 的互斥锁
+  ThreadQoSClass qosClass_;                                     ///< 线程服务质量等级
+  ThreadQoS::NativeId threadId_ = 0;                            ///< 运行中的工作线程 ID（0 表示没有）
+  bool disableSyncCallsInCallingThread_ = false;                ///< 是否禁用在调用线程中执行同步任务
+  std::atomic<std::chrono::steady_clock::rep> idleTimeout_{0};  ///< 空闲超时（steady_clock 计数，0 表示不退出）
+  std::atomic<uint64_t> threadStarts_{0};                       ///< 工作线程启动次数
+  std::atomic<uint64_t> threadRetirements_{0};                  ///< 工作线程因空闲超时退出的次数
+  std::atomic<size_t> stackBytes_{0};                           ///< 当前工作线程的栈大小
 
   /**
    * @brief 工作线程处理函数
@@ -147,7 +284,7 @@ class ThreadedDispatchQueue : public DispatchQueue {
   void teardown();
 
   /**
-   * @brief 启动工作线程
+   * @brief 启动工作线程（回收因空闲超时退出的上一个线程）
    */
   void startThread();
 
@@ -0,0 +1,403 @@
+/**
+ * @file TimerWheel.h
+ * @brief 分层时间轮
+ *
+ * 为延迟任务提供 O(1) 插入/删除和均摊 O(1) 到期处理的定时器结构。
+ * 由 TaskQueue 内部使用，本身不是线程安全的，需要在外部锁保护下访问。
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace dispatch {
+
+/**
+ * @brief 时间轮侵入式节点
+ *
+ * 需要放入时间轮的对象必须继承此结构。
+ * 节点在槽位链表中时使用 prev/next，在到期堆中时使用 heapIndex。
+ */
+struct TimerWheelHook {
+  static constexpr uint32_t kNotInHeap = UINT32_MAX;
+
+  TimerWheelHook* prev = nullptr;   ///< 槽位链表前驱
+  TimerWheelHook* next = nullptr;   ///< 槽位链表后继
+  uint32_t heapIndex = kNotInHeap;  ///< 在到期堆中的位置
+};
+
+/**
+ * @brief 分层时间轮
+ *
+ * 结构：
+ * - kLevels 层，每层 64 个槽位，第 l 层每个槽位覆盖 64^l 个 tick
+ * - 每层一个 64 位占用位图，推进时直接跳到下一个非空槽位，空闲期间不做无用功
+ * - 超出最高层范围的节点放入溢出链表，跨越最高层边界时重新分配
+ * - 当前 tick 内的节点进入一个按 (executeTime, id) 排序的小顶堆，
+ *   保证到期顺序精确且相同执行时间的任务先入先出
+ *
+ * @tparam Node 节点类型，需继承 TimerWheelHook 并提供 executeTime 和 id 成员
+ */
+template <typename Node>
+class TimerWheel {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr int kSlotBits = 6;
+  static constexpr int kSlots = 1 << kSlotBits;
+  static constexpr int kLevels = 6;
+
+  /**
+   * @brief 构造函数
+   * @param tick 时间轮精度（最低层每个槽位的时间跨度）
+   */
+  explicit TimerWheel(Clock::duration tick = std::chrono::milliseconds(1)) : origin_(Clock::now()), tick_(tick) {
+    for (auto& bucket : buckets_) {
+      bucket.prev = &bucket;
+      bucket.next = &bucket;
+    }
+    overflow_.prev = &overflow_;
+    overflow_.next = &overflow_;
+  }
+
+  TimerWheel(const TimerWheel& other) = delete;
+  TimerWheel& operator=(const TimerWheel& other) = delete;
+
+  /// 时间轮中的节点数量
+  size_t size() const { return size_; }
+
+  /// 时间轮是否为空
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * @brief 插入节点，O(1)
+   * @param node 节点（不能已在时间轮中）
+   */
+  void insert(Node* node) {
+    size_++;
+    place(node, tickOf(node->executeTime));
+  }
+
+  /**
+   * @brief 移除节点，O(1)（若节点已进入到期堆则为 O(log k)，k 为当前 tick 内的节点数）
+   * @param node 节点（必须在时间轮中）
+   */
+  void remove(Node* node) {
+    size_--;
+    if (node->heapIndex != TimerWheelHook::kNotInHeap) {
+      heapErase(node);
+      return;
+    }
+
+    auto* prev = node->prev;
+    auto* next = node->next;
+    prev->next = next;
+    next->prev = prev;
+    node->prev = nullptr;
+    node->next = nullptr;
+
+    // 链表变空时清除对应的占用位
+    if (prev == next && prev >= &buckets_.front() && prev <= &buckets_.back()) {
+      auto index = static_cast<size_t>(prev - &buckets_.front());
+      occupied_[index / kSlots] &= ~(uint64_t(1) << (index % kSlots));
+    }
+  }
+
+  /**
+   * @brief 处理所有已到期的节点
+   *
+   * 按 (executeTime, id) 顺序对每个 executeTime <= now 的节点调用 onExpired，
+   * 回调时节点已经从时间轮中移除。
+   *
+   * @param now 当前时间
+   * @param onExpired 到期回调，签名为 void(Node*)
+   * @return size_t 到期的节点数量
+   */
+  template <typename F>
+  size_t expire(Clock::time_point now, F&& onExpired) {
+    advance(tickOf(now));
+
+    size_t expired = 0;
+    while (!due_.empty() && due_.front()->executeTime <= now) {
+      auto* node = due_.front();
+      heapErase(node);
+      size_--;
+      expired++;
+      onExpired(node);
+    }
+    return expired;
+  }
+
+  /**
+   * @brief 获取下一次需要检查时间轮的时间点
+   *
+   * 返回值不会晚于最早节点的执行时间，但可能更早（例如需要级联高层槽位时）。
+   *
+   * @return Clock::time_point 时间点，时间轮为空时返回 time_point::max()
+   */
+  Clock::time_point nextExpiry() const {
+    if (!due_.empty()) {
+      return due_.front()->executeTime;
+    }
+    uint64_t eventTick;
+    if (nextEventTick(&eventTick)) {
+      return origin_ + tick_ * static_cast<Clock::rep>(eventTick);
+    }
+    return Clock::time_point::max();
+  }
+
+  /**
+   * @brief 清空时间轮
+   * @param onNode 对每个被移除的节点调用，签名为 void(Node*)
+   */
+  template <typename F>
+  void clear(F&& onNode) {
+    for (auto& bucket : buckets_) {
+      drainList(&bucket, onNode);
+    }
+    drainList(&overflow_, onNode);
+    for (auto* node : due_) {
+      node->heapIndex = TimerWheelHook::kNotInHeap;
+      onNode(node);
+    }
+    due_.clear();
+    occupied_.fill(0);
+    size_ = 0;
+  }
+
+ private:
+  static constexpr int kTotalBits = kSlotBits * kLevels;
+
+  Clock::time_point origin_;                              ///< tick 0 对应的时间点
+  Clock::duration tick_;                                  ///< 时间轮精度
+  uint64_t now_ = 0;                                      ///< 已推进到的 tick
+  size_t size_ = 0;                                       ///< 节点数量
+  std::array<TimerWheelHook, kLevels * kSlots> buckets_;  ///< 各层槽位（哨兵节点）
+  std::array<uint64_t, kLevels> occupied_{};              ///< 各层占用位图
+  TimerWheelHook overflow_;                               ///< 超出范围的节点
+  std::vector<Node*> due_;                                ///< 当前 tick 内的节点（小顶堆）
+
+  static int highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = -1;
+    while (value != 0) {
+      value >>= 1;
+      bit++;
+    }
+    return bit;
+#endif
+  }
+
+  static int lowestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    int bit = 0;
+    while ((value & 1) == 0) {
+      value >>= 1;
+      bit++;
+    }
+    return bit;
+#endif
+  }
+
+  /// 大于 slot 的所有位
+  static uint64_t maskAbove(uint64_t slot) { return slot >= kSlots - 1 ? 0 : (~uint64_t(0) << (slot + 1)); }
+
+  uint64_t tickOf(Clock::time_point time) const {
+    if (time <= origin_) {
+      return 0;
+    }
+    return static_cast<uint64_t>((time - origin_) / tick_);
+  }
+
+  static void linkBack(TimerWheelHook* list, TimerWheelHook* node) {
+    node->prev = list->prev;
+    node->next = list;
+    list->prev->next = node;
+    list->prev = node;
+  }
+
+  template <typename F>
+  static void drainList(TimerWheelHook* list, F& onNode) {
+    auto* hook = list->next;
+    while (hook != list) {
+      auto* next = hook->next;
+      hook->prev = nullptr;
+      hook->next = nullptr;
+      onNode(static_cast<Node*>(hook));
+      hook = next;
+    }
+    list->prev = list;
+    list->next = list;
+  }
+
+  /**
+   * @brief 根据到期 tick 将节点放入合适的层级
+   *
+   * 层级由到期 tick 与当前 tick 最高的不同位决定，
+   * 这样某一层的槽位被推进到时，其中的节点恰好需要下沉到更低层级。
+   */
+  void place(Node* node, uint64_t expiryTick) {
+    if (expiryTick <= now_) {
+      heapPush(node);
+      return;
+    }
+
+    int level = highestBit(expiryTick ^ now_) / kSlotBits;
+    if (level >= kLevels) {
+      linkBack(&overflow_, node);
+      return;
+    }
+
+    auto slot = (expiryTick >> (level * kSlotBits)) & (kSlots - 1);
+    linkBack(&buckets_[level * kSlots + slot], node);
+    occupied_[level] |= uint64_t(1) << slot;
+  }
+
+  /**
+   * @brief 计算下一个需要处理的 tick
+   * @param eventTick 输出参数
+   * @param eventLevel 输出参数，事件所在层级（kLevels 表示溢出链表）
+   * @return true 存在待处理的事件
+   */
+  bool nextEventTick(uint64_t* eventTick, int* eventLevel = nullptr) const {
+    for (int level = 0; level < kLevels; ++level) {
+      auto shift = level * kSlotBits;
+      auto current = (now_ >> shift) & (kSlots - 1);
+      auto pending = occupied_[level] & maskAbove(current);
+      if (pending != 0) {
+        auto base = (now_ >> (shift + kSlotBits)) << (shift + kSlotBits);
+        *eventTick = base | (static_cast<uint64_t>(lowestBit(pending)) << shift);
+        if (eventLevel != nullptr) {
+          *eventLevel = level;
+        }
+        return true;
+      }
+    }
+
+    if (overflow_.next != &overflow_) {
+      *eventTick = ((now_ >> kTotalBits) + 1) << kTotalBits;
+      if (eventLevel != nullptr) {
+        *eventLevel = kLevels;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief 推进时间轮到指定 tick
+   *
+   * 只在非空槽位处停留：最低层槽位中的节点进入到期堆，高层槽位中的节点级联到低层。
+   */
+  void advance(uint64_t target) {
+    while (true) {
+      uint64_t eventTick;
+      int eventLevel;
+      if (!nextEventTick(&eventTick, &eventLevel) || eventTick > target) {
+        if (target > now_) {
+          now_ = target;
+        }
+        return;
+      }
+
+      now_ = eventTick;
+
+      TimerWheelHook* list;
+      if (eventLevel == kLevels) {
+        list = &overflow_;
+      } else {
+        auto slot = (now_ >> (eventLevel * kSlotBits)) & (kSlots - 1);
+        list = &buckets_[eventLevel * kSlots + slot];
+        occupied_[eventLevel] &= ~(uint64_t(1) << slot);
+      }
+
+      // 先摘下整条链表，再逐个重新放置（可能回到同一链表）
+      auto* hook = list->next;
+      list->prev = list;
+      list->next = list;
+      while (hook != list) {
+        auto* next = hook->next;
+        auto* node = static_cast<Node*>(hook);
+        node->prev = nullptr;
+        node->next = nullptr;
+        place(node, tickOf(node->executeTime));
+        hook = next;
+      }
+    }
+  }
+
+  static bool before(const Node* a, const Node* b) {
+    if (a->executeTime == b->executeTime) {
+      return a->id < b->id;
+    }
+    return a->executeTime < b->executeTime;
+  }
+
+  void heapSet(size_t index, Node* node) {
+    due_[index] = node;
+    node->heapIndex = static_cast<uint32_t>(index);
+  }
+
+  void siftUp(size_t index) {
+    auto* node = due_[index];
+    while (index > 0) {
+      auto parent = (index - 1) / 2;
+      if (!before(node, due_[parent])) {
+        break;
+      }
+      heapSet(index, due_[parent]);
+      index = parent;
+    }
+    heapSet(index, node);
+  }
+
+  void siftDown(size_t index) {
+    auto* node = due_[index];
+    auto count = due_.size();
+    while (true) {
+      auto child = index * 2 + 1;
+      if (child >= count) {
+        break;
+      }
+      if (child + 1 < count && before(due_[child + 1], due_[child])) {
+        child++;
+      }
+      if (!before(due_[child], node)) {
+        break;
+      }
+      heapSet(index, due_[child]);
+      index = child;
+    }
+    heapSet(index, node);
+  }
+
+  void heapPush(Node* node) {
+    due_.push_back(node);
+    siftUp(due_.size() - 1);
+  }
+
+  void heapErase(Node* node) {
+    size_t index = node->heapIndex;
+    auto* last = due_.back();
+    due_.pop_back();
+    node->heapIndex = TimerWheelHook::kNotInHeap;
+    if (last == node) {
+      return;
+    }
+    heapSet(index, last);
+    if (index > 0 && before(last, due_[(index - 1) / 2])) {
+      siftUp(index);
+    } else {
+      siftDown(index);
+    }
+  }
+};
+
+}  // namespace dispatch
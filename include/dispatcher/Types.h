@@ -10,6 +10,8 @@
 #include <cstdint>
 #include <functional>
 
+#include "TaskFunction.h"
+
 namespace dispatch {
 
 /**
@@ -25,6 +27,9 @@ using TaskId = int64_t;
  *
  * 无参数、无返回值的可调用对象，代表一个待执行的任务。
  * 可以是 lambda、函数指针、std::bind 结果等。
+ *
+ * @note 队列接口使用仅可移动的 TaskFunction 存储任务，DispatchFunction 保留用于兼容，
+ *       传入 DispatchFunction 的地方会隐式转换为 TaskFunction。
  */
 using DispatchFunction = std::function<void()>;
 
@@ -0,0 +1,133 @@
+/**
+ * @file WorkStealingDeque.h
+ * @brief 工作窃取双端队列
+ *
+ * 每个线程池工作线程拥有一个本地队列：拥有者从尾部压入和弹出（后进先出），
+ * 其他线程从头部窃取（先进先出）。由 ThreadPoolDispatchQueue 内部使用。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace dispatch {
+
+/**
+ * @brief 工作窃取双端队列
+ *
+ * 固定容量的 Chase-Lev 队列（按 C11 内存模型的实现）：
+ * - push/pop 只能由拥有者线程调用，无竞争时不执行 CAS
+ * - steal 可以由任意线程调用，与 pop 争夺最后一个元素时通过 CAS 决定归属
+ * - 容量固定，队列满时 push 返回 false，由调用者退回到全局队列
+ *
+ * 元素只保存指针，窃取失败时读取到的值直接丢弃，不需要对元素做额外同步。
+ *
+ * @tparam T 元素类型（队列中保存 T*）
+ */
+template <typename T>
+class WorkStealingDeque {
+ public:
+  /**
+   * @brief 构造函数
+   * @param capacity 容量，必须是 2 的幂
+   */
+  explicit WorkStealingDeque(size_t capacity)
+      : slots_(new std::atomic<T*>[capacity]), mask_(static_cast<int64_t>(capacity) - 1) {}
+
+  WorkStealingDeque(const WorkStealingDeque& other) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+
+  /**
+   * @brief 压入元素（仅拥有者）
+   * @param item 元素
+   * @return true 压入成功
+   * @return false 队列已满
+   */
+  bool push(T* item) {
+    auto bottom = bottom_.load(std::memory_order_relaxed);
+    auto top = top_.load(std::memory_order_acquire);
+    if (bottom - top > mask_) {
+      return false;
+    }
+    slots_[bottom & mask_].store(item, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief 弹出最近压入的元素（仅拥有者）
+   * @return T* 元素，队列为空或最后一个元素被窃取时返回 nullptr
+   */
+  T* pop() {
+    auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = top_.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      // 队列为空，恢复 bottom
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    auto* item = slots_[bottom & mask_].load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // 最后一个元素，与窃取者竞争
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  /**
+   * @brief 窃取最早压入的元素（任意线程）
+   * @return T* 元素，队列为空或与其他线程竞争失败时返回 nullptr
+   */
+  T* steal() {
+    auto top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return nullptr;
+    }
+
+    auto* item = slots_[top & mask_].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  /**
+   * @brief 检查队列是否为空（任意线程，结果只是瞬时值）
+   */
+  bool empty() const {
+    auto top = top_.load(std::memory_order_acquire);
+    auto bottom = bottom_.load(std::memory_order_acquire);
+    return top >= bottom;
+  }
+
+  /**
+   * @brief 获取队列中的元素数量（任意线程，结果只是瞬时值）
+   */
+  size_t size() const {
+    auto top = top_.load(std::memory_order_acquire);
+    auto bottom = bottom_.load(std::memory_order_acquire);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+  }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  std::unique_ptr<std::atomic<T*>[]> slots_;                ///< 环形槽位
+  int64_t mask_;                                            ///< 容量掩码
+  alignas(kCacheLineSize) std::atomic<int64_t> top_{0};     ///< 窃取端位置
+  alignas(kCacheLineSize) std::atomic<int64_t> bottom_{0};  ///< 拥有者端位置
+};
+
+}  // namespace dispatch
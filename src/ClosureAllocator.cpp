@@ -0,0 +1,189 @@
+/**
+ * @file ClosureAllocator.cpp
+ * @brief 任务闭包的池化分配器实现
+ */
+
+#include "dispatcher/ClosureAllocator.h"
+
+#include <mutex>
+#include <new>
+
+namespace dispatch {
+
+namespace {
+
+constexpr size_t kSizeClasses = 4;       ///< 大小级别数量（64/128/256/512）
+constexpr size_t kMinClassSize = 64;     ///< 最小级别的块大小
+constexpr size_t kTransferBatch = 32;    ///< 线程缓存与 slab 之间每次转移的块数
+constexpr size_t kMaxCachedBlocks = 64;  ///< 每个线程每个级别缓存的块数上限
+
+static_assert(kMinClassSize << (kSizeClasses - 1) == ClosureAllocator::kMaxPooledSize,
+              "Size classes must cover kMaxPooledSize");
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+/**
+ * @brief 单个大小级别的共享 slab
+ */
+struct SizeClass {
+  std::mutex mutex;
+  SlabAllocator slabs;
+
+  explicit SizeClass(size_t size) : slabs(size) {}
+};
+
+/// 所有大小级别（有意不释放，线程退出时的缓存归还可能发生在静态对象析构之后）
+SizeClass* sizeClasses() {
+  static SizeClass* classes = [] {
+    auto* memory = static_cast<SizeClass*>(::operator new(sizeof(SizeClass) * kSizeClasses));
+    for (size_t i = 0; i < kSizeClasses; ++i) {
+      ::new (&memory[i]) SizeClass(kMinClassSize << i);
+    }
+    return memory;
+  }();
+  return classes;
+}
+
+size_t classIndexOf(size_t size) {
+  size_t index = 0;
+  while ((kMinClassSize << index) < size) {
+    index++;
+  }
+  return index;
+}
+
+void returnBlocks(size_t index, FreeBlock* head) {
+  auto& sizeClass = sizeClasses()[index];
+  std::lock_guard<std::mutex> lock(sizeClass.mutex);
+  while (head != nullptr) {
+    auto* next = head->next;
+    sizeClass.slabs.deallocate(head);
+    head = next;
+  }
+}
+
+/**
+ * @brief 线程本地的空闲块缓存
+ */
+struct ThreadCache {
+  FreeBlock* blocks[kSizeClasses] = {};  ///< 每个级别的空闲块链表
+  size_t counts[kSizeClasses] = {};      ///< 每个级别的空闲块数量
+
+  ~ThreadCache();
+
+  void* allocate(size_t index) {
+    if (blocks[index] == nullptr) {
+      refill(index);
+    }
+    auto* block = blocks[index];
+    blocks[index] = block->next;
+    counts[index]--;
+    return block;
+  }
+
+  void deallocate(size_t index, void* memory) {
+    auto* block = static_cast<FreeBlock*>(memory);
+    block->next = blocks[index];
+    blocks[index] = block;
+    if (++counts[index] > kMaxCachedBlocks) {
+      release(index, kTransferBatch);
+    }
+  }
+
+  void refill(size_t index) {
+    auto& sizeClass = sizeClasses()[index];
+    std::lock_guard<std::mutex> lock(sizeClass.mutex);
+    for (size_t i = 0; i < kTransferBatch; ++i) {
+      auto* block = static_cast<FreeBlock*>(sizeClass.slabs.allocate());
+      block->next = blocks[index];
+      blocks[index] = block;
+    }
+    counts[index] += kTransferBatch;
+  }
+
+  void release(size_t index, size_t count) {
+    FreeBlock* head = nullptr;
+    for (size_t i = 0; i < count && blocks[index] != nullptr; ++i) {
+      auto* block = blocks[index];
+      blocks[index] = block->next;
+      block->next = head;
+      head = block;
+      counts[index]--;
+    }
+    returnBlocks(index, head);
+  }
+};
+
+/// 线程缓存是否已析构（平凡类型，线程退出期间仍可安全访问）
+thread_local bool threadCacheDestroyed = false;
+
+ThreadCache::~ThreadCache() {
+  threadCacheDestroyed = true;
+  for (size_t i = 0; i < kSizeClasses; ++i) {
+    returnBlocks(i, blocks[i]);
+    blocks[i] = nullptr;
+    counts[i] = 0;
+  }
+}
+
+thread_local ThreadCache threadCache;
+
+}  // namespace
+
+void* ClosureAllocator::allocate(size_t size) {
+  if (size > kMaxPooledSize) {
+    return ::operator new(size);
+  }
+
+  auto index = classIndexOf(size);
+  if (threadCacheDestroyed) {
+    auto& sizeClass = sizeClasses()[index];
+    std::lock_guard<std::mutex> lock(sizeClass.mutex);
+    return sizeClass.slabs.allocate();
+  }
+  return threadCache.allocate(index);
+}
+
+void ClosureAllocator::deallocate(void* memory, size_t size) noexcept {
+  if (size > kMaxPooledSize) {
+    ::operator delete(memory);
+    return;
+  }
+
+  auto index = classIndexOf(size);
+  if (threadCacheDestroyed) {
+    auto* block = static_cast<FreeBlock*>(memory);
+    block->next = nullptr;
+    returnBlocks(index, block);
+    return;
+  }
+  threadCache.deallocate(index, memory);
+}
+
+void ClosureAllocator::setMaxRetainedSlabs(size_t maxRetainedSlabs) {
+  for (size_t i = 0; i < kSizeClasses; ++i) {
+    auto& sizeClass = sizeClasses()[i];
+    std::lock_guard<std::mutex> lock(sizeClass.mutex);
+    sizeClass.slabs.setMaxRetainedSlabs(maxRetainedSlabs);
+  }
+}
+
+AllocatorStats ClosureAllocator::stats() {
+  AllocatorStats total;
+  for (size_t i = 0; i < kSizeClasses; ++i) {
+    auto& sizeClass = sizeClasses()[i];
+    std::lock_guard<std::mutex> lock(sizeClass.mutex);
+    auto stats = sizeClass.slabs.stats();
+    total.slabsInUse += stats.slabsInUse;
+    total.slabsRetained += stats.slabsRetained;
+    total.objectsInUse += stats.objectsInUse;
+    total.bytesRetained += stats.bytesRetained;
+    total.systemAllocations += stats.systemAllocations;
+    total.systemReleases += stats.systemReleases;
+  }
+  return total;
+}
+
+}  // namespace dispatch
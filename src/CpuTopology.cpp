@@ -0,0 +1,227 @@
+/**
+ * @file CpuTopology.cpp
+ * @brief CPU 拓扑与线程绑定实现
+ */
+
+#include "dispatcher/CpuTopology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace dispatch {
+
+namespace {
+
+#ifdef __linux__
+
+/// 解析 "0-3,8,10-11" 格式的 CPU 列表
+std::vector<int> parseCpuList(const std::string& text) {
+  std::vector<int> cpus;
+  std::stringstream stream(text);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    auto dash = range.find('-');
+    try {
+      int first = std::stoi(range.substr(0, dash));
+      int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::exception&) {
+      return {};
+    }
+  }
+  return cpus;
+}
+
+/// 读取文件的第一行，失败时返回空字符串
+std::string readLine(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+/// 读取整数文件，失败时返回 fallback
+int readInt(const std::string& path, int fallback) {
+  auto line = readLine(path);
+  try {
+    return line.empty() ? fallback : std::stoi(line);
+  } catch (const std::exception&) {
+    return fallback;
+  }
+}
+
+#endif  // __linux__
+
+}  // namespace
+
+CpuTopology CpuTopology::detect() {
+  CpuTopology topology;
+
+#ifdef __linux__
+  const std::string cpuRoot = "/sys/devices/system/cpu/";
+  const std::string nodeRoot = "/sys/devices/system/node/";
+
+  auto online = parseCpuList(readLine(cpuRoot + "online"));
+  for (int cpu : online) {
+    CpuInfo info;
+    info.cpu = cpu;
+    auto topologyDir = cpuRoot + "cpu" + std::to_string(cpu) + "/topology/";
+    info.core = readInt(topologyDir + "core_id", cpu);
+    info.package = readInt(topologyDir + "physical_package_id", 0);
+    topology.cpus_.push_back(info);
+  }
+
+  // NUMA 节点编号可能不连续，按出现顺序重新编号
+  auto nodes = parseCpuList(readLine(nodeRoot + "online"));
+  size_t nodeIndex = 0;
+  for (int node : nodes) {
+    auto members = parseCpuList(readLine(nodeRoot + "node" + std::to_string(node) + "/cpulist"));
+    bool used = false;
+    for (auto& info : topology.cpus_) {
+      if (std::find(members.begin(), members.end(), info.cpu) != members.end()) {
+        info.node = nodeIndex;
+        used = true;
+      }
+    }
+    if (used) {
+      nodeIndex++;
+    }
+  }
+  topology.node_count_ = std::max<size_t>(nodeIndex, 1);
+#endif
+
+  // 无法读取 /sys 时每个逻辑 CPU 视为一个核心
+  if (topology.cpus_.empty()) {
+    int count = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+    for (int cpu = 0; cpu < count; ++cpu) {
+      CpuInfo info;
+      info.cpu = cpu;
+      info.core = cpu;
+      topology.cpus_.push_back(info);
+    }
+    topology.node_count_ = 1;
+  }
+
+  for (const auto& info : topology.cpus_) {
+    if (topology.cpu_nodes_.size() <= static_cast<size_t>(info.cpu)) {
+      topology.cpu_nodes_.resize(info.cpu + 1, 0);
+    }
+    topology.cpu_nodes_[info.cpu] = info.node;
+  }
+  return topology;
+}
+
+size_t CpuTopology::nodeOf(int cpu) const {
+  if (cpu < 0 || static_cast<size_t>(cpu) >= cpu_nodes_.size()) {
+    return 0;
+  }
+  return cpu_nodes_[cpu];
+}
+
+std::vector<int> CpuTopology::layout(WorkerPlacement placement, const std::vector<int>& allowed) const {
+  auto allowedCpus = allowed.empty() ? currentAffinity() : allowed;
+
+  std::vector<CpuInfo> candidates;
+  for (const auto& info : cpus_) {
+    if (allowedCpus.empty() || std::find(allowedCpus.begin(), allowedCpus.end(), info.cpu) != allowedCpus.end()) {
+      candidates.push_back(info);
+    }
+  }
+
+  // 紧凑布局（以及 None）：按节点、封装、核心排序，同一核心的超线程相邻
+  std::sort(candidates.begin(), candidates.end(), [](const CpuInfo& a, const CpuInfo& b) {
+    return std::tie(a.node, a.package, a.core, a.cpu) < std::tie(b.node, b.package, b.core, b.cpu);
+  });
+  if (placement == WorkerPlacement::None) {
+    std::sort(candidates.begin(), candidates.end(), [](const CpuInfo& a, const CpuInfo& b) { return a.cpu < b.cpu; });
+  }
+
+  std::vector<int> result;
+  if (placement != WorkerPlacement::Spread) {
+    for (const auto& info : candidates) {
+      result.push_back(info.cpu);
+    }
+    return result;
+  }
+
+  // 分散布局：每个节点内先取每个核心的第一个超线程，再取第二个……；然后各节点轮流取一个
+  std::map<std::pair<int, int>, int> siblingRank;
+  std::vector<std::vector<std::pair<int, int>>> perNode(node_count_);
+  for (const auto& info : candidates) {
+    int rank = siblingRank[{info.package, info.core}]++;
+    perNode[info.node].emplace_back(rank, info.cpu);
+  }
+  for (auto& list : perNode) {
+    std::stable_sort(list.begin(), list.end(),
+                     [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; });
+  }
+
+  for (size_t round = 0; result.size() < candidates.size(); ++round) {
+    for (const auto& list : perNode) {
+      if (round < list.size()) {
+        result.push_back(list[round].second);
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<int> CpuTopology::currentAffinity() {
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+#endif
+  return cpus;
+}
+
+bool CpuTopology::bindCurrentThread(const std::vector<int>& cpus) {
+#ifdef __linux__
+  if (cpus.empty()) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+int CpuTopology::currentCpu() {
+#ifdef __linux__
+  return sched_getcpu();
+#else
+  return -1;
+#endif
+}
+
+}  // namespace dispatch
@@ -0,0 +1,148 @@
+/**
+ * @file DispatchGroup.cpp
+ * @brief 调度组实现
+ */
+
+#include "dispatcher/DispatchGroup.h"
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "dispatcher/IDispatchQueue.h"
+
+namespace dispatch {
+
+/**
+ * @brief 调度组的共享状态
+ *
+ * count 是唯一的计数；mutex 只保护归零时的唤醒与后续任务列表。
+ */
+struct DispatchGroup::State {
+  /// 已注册的后续任务
+  struct Notification {
+    std::shared_ptr<IDispatchQueue> queue;
+    TaskFunction function;
+  };
+
+  std::atomic<int64_t> count{0};            ///< 未完成的任务数
+  std::mutex mutex;                         ///< 保护以下成员
+  std::condition_variable condition;        ///< 计数归零时通知 wait()
+  uint64_t generation = 0;                  ///< 归零次数，防止等待者错过短暂的归零
+  size_t waiters = 0;                       ///< 正在 wait() 的线程数
+  std::vector<Notification> notifications;  ///< 等待计数归零的后续任务
+
+  void leave() {
+    auto previous = count.fetch_sub(1, std::memory_order_acq_rel);
+    assert(previous > 0 && "DispatchGroup::leave() without matching enter()");
+    if (previous == 1) {
+      complete();
+    }
+  }
+
+  /// 计数归零：唤醒等待者并投递后续任务
+  void complete() {
+    std::vector<Notification> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      generation++;
+      if (waiters != 0) {
+        condition.notify_all();
+      }
+      // 加锁前已被再次 enter() 的组尚未完成，后续任务留到下一次归零
+      if (count.load(std::memory_order_acquire) == 0) {
+        ready.swap(notifications);
+      }
+    }
+
+    for (auto& notification : ready) {
+      notification.queue->async(std::move(notification.function));
+    }
+  }
+};
+
+namespace {
+
+/**
+ * @brief 组成员身份
+ *
+ * 随组内任务的闭包一起移动，销毁时离开组：
+ * 无论任务是执行完毕、被取消还是随队列销毁而丢弃，都恰好离开一次。
+ */
+template <typename State>
+class Membership {
+ public:
+  explicit Membership(std::shared_ptr<State> state) : state_(std::move(state)) {}
+  Membership(Membership&& other) noexcept = default;
+  Membership& operator=(Membership&& other) = delete;
+  ~Membership() {
+    if (state_ != nullptr) {
+      state_->leave();
+    }
+  }
+
+ private:
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace
+
+DispatchGroup::DispatchGroup() : state_(std::make_shared<State>()) {}
+
+void DispatchGroup::enter() const { state_->count.fetch_add(1, std::memory_order_relaxed); }
+
+void DispatchGroup::leave() const { state_->leave(); }
+
+void DispatchGroup::wait() const {
+  if (state_->count.load(std::memory_order_acquire) == 0) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  auto generation = state_->generation;
+  state_->waiters++;
+  state_->condition.wait(lock, [this, generation]() {
+    return state_->generation != generation || state_->count.load(std::memory_order_acquire) == 0;
+  });
+  state_->waiters--;
+}
+
+bool DispatchGroup::wait(std::chrono::steady_clock::duration timeout) const {
+  if (state_->count.load(std::memory_order_acquire) == 0) {
+    return true;
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  auto generation = state_->generation;
+  state_->waiters++;
+  bool completed = state_->condition.wait_until(lock, deadline, [this, generation]() {
+    return state_->generation != generation || state_->count.load(std::memory_order_acquire) == 0;
+  });
+  state_->waiters--;
+  return completed;
+}
+
+void DispatchGroup::notify(const std::shared_ptr<IDispatchQueue>& queue, TaskFunction function) const {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    // 计数归零的线程在加锁后才取出列表，因此这里看到非零计数时注册的任务不会被遗漏
+    if (state_->count.load(std::memory_order_acquire) != 0) {
+      state_->notifications.push_back({queue, std::move(function)});
+      return;
+    }
+  }
+  queue->async(std::move(function));
+}
+
+int64_t DispatchGroup::pendingCount() const { return state_->count.load(std::memory_order_acquire); }
+
+TaskFunction DispatchGroup::track(TaskFunction function) const {
+  enter();
+  return [membership = Membership<State>(state_), function = std::move(function)]() mutable { function(); };
+}
+
+}  // namespace dispatch
@@ -7,6 +7,7 @@
 
 #include <future>
 
+#include "dispatcher/SerialDispatchQueue.h"
 #include "dispatcher/ThreadedDispatchQueue.h"
 
 namespace dispatch {
@@ -18,7 +19,7 @@ DispatchQueue::DispatchQueue() = default;
 
 DispatchQueue::~DispatchQueue() = default;
 
-bool DispatchQueue::safeSync(const DispatchFunction& function) {
+bool DispatchQueue::safeSync(const TaskFunction& function) {
   if (isCurrent()) {
     // 已在队列线程中，直接执行避免死锁
     function();
@@ -50,6 +51,30 @@ void DispatchQueue::setDisableSyncCallsInCallingThread(bool /*disableSyncCallsIn
   // 子类可以覆盖此方法
 }
 
+void DispatchQueue::setIdleTimeout(std::chrono::steady_clock::duration /*idleTimeout*/) {
+  // 基类默认实现：不做任何事
+  // 子类可以覆盖此方法
+}
+
+void DispatchQueue::setSchedulingPolicy(SchedulingPolicy /*policy*/) {
+  // 基类默认实现：不做任何事
+  // 子类可以覆盖此方法
+}
+
+void DispatchQueue::setDeadlineMissPolicy(DeadlineMissPolicy /*policy*/) {
+  // 基类默认实现：不做任何事
+  // 子类可以覆盖此方法
+}
+
+DeadlineStats DispatchQueue::deadlineStats() const { return DeadlineStats(); }
+
+void DispatchQueue::setCapacity(size_t /*capacity*/, OverflowPolicy /*policy*/) {
+  // 基类默认实现：不做任何事
+  // 子类可以覆盖此方法
+}
+
+OverflowStats DispatchQueue::overflowStats() const { return OverflowStats(); }
+
 void DispatchQueue::setMain(const std::shared_ptr<DispatchQueue>& main) { main_ = main; }
 
 DispatchQueue* DispatchQueue::getMain() { return main_.get(); }
@@ -59,6 +84,18 @@ std::shared_ptr<DispatchQueue> DispatchQueue::create(const std::string& name, Th
   return createThreaded(name, qosClass);
 }
 
-DispatchQueue* DispatchQueue::getCurrent() { return ThreadedDispatchQueue::getCurrent(); }
+std::shared_ptr<DispatchQueue> DispatchQueue::create(const std::string& name,
+                                                     const std::shared_ptr<IDispatchQueue>& target,
+                                                     size_t maxBatchSize) {
+  return std::make_shared<SerialDispatchQueue>(name, target, maxBatchSize);
+}
+
+DispatchQueue* DispatchQueue::getCurrent() {
+  // 串行队列的任务运行在其他队列的线程上，优先返回最内层的串行队列
+  if (auto* serial = SerialDispatchQueue::getCurrent()) {
+    return serial;
+  }
+  return ThreadedDispatchQueue::getCurrent();
+}
 
 }  // namespace dispatch
@@ -0,0 +1,262 @@
+/**
+ * @file SerialDispatchQueue.cpp
+ * @brief 复用目标队列线程的串行队列实现
+ */
+
+#include "dispatcher/SerialDispatchQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "dispatcher/DispatchGroup.h"
+
+namespace dispatch {
+
+// 线程本地存储：当前线程正在执行的串行队列
+static thread_local SerialDispatchQueue* current_ = nullptr;
+
+// 线程本地存储：当前线程是否正在重新投递被丢弃的排空任务
+static thread_local bool reposting_ = false;
+
+/**
+ * @brief 排空任务持有的凭证：任务未执行就被销毁时通知队列重新投递
+ */
+class SerialDispatchQueue::DrainTicket {
+ public:
+  explicit DrainTicket(std::weak_ptr<SerialDispatchQueue> queue) : queue_(std::move(queue)) {}
+  DrainTicket(DrainTicket&& other) noexcept : queue_(std::move(other.queue_)), ran_(std::exchange(other.ran_, true)) {}
+  DrainTicket& operator=(DrainTicket&&) = delete;
+
+  ~DrainTicket() {
+    if (ran_) {
+      return;
+    }
+    if (auto queue = queue_.lock()) {
+      queue->drainDropped();
+    }
+  }
+
+  /// 执行排空任务
+  void run() const {
+    ran_ = true;
+    if (auto queue = queue_.lock()) {
+      queue->drain();
+    }
+  }
+
+ private:
+  std::weak_ptr<SerialDispatchQueue> queue_;  ///< 所属的串行队列
+  mutable bool ran_ = false;                  ///< 是否已执行（被移走的凭证视为已执行）
+};
+
+SerialDispatchQueue::SerialDispatchQueue(const std::string& name, std::shared_ptr<IDispatchQueue> target,
+                                         size_t maxBatchSize)
+    : taskQueue_(std::make_shared<TaskQueue>()),
+      target_(std::move(target)),
+      name_(name),
+      maxBatchSize_(std::max<size_t>(maxBatchSize, 1)) {}
+
+SerialDispatchQueue::~SerialDispatchQueue() { taskQueue_->dispose(); }
+
+void SerialDispatchQueue::sync(const TaskFunction& function) {
+  if (isCurrent()) {
+    // 已在本队列的任务中，直接执行避免死锁
+    function();
+    return;
+  }
+
+  // 没有专属线程可以执行屏障，提交任务后等待其执行完毕
+  // 组成员身份随任务销毁而离开，队列被销毁、任务被丢弃时也不会一直阻塞
+  DispatchGroup group;
+  async(group, [this, &function]() {
+    runningSync_ = true;
+    function();
+    runningSync_ = false;
+  });
+  group.wait();
+}
+
+void SerialDispatchQueue::async(TaskFunction function) {
+  taskQueue_->enqueue(std::move(function));
+  scheduleDrain();
+}
+
+TaskId SerialDispatchQueue::asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay) {
+  auto task = taskQueue_->enqueue(std::move(function), delay);
+  scheduleTimer(delay);
+  return task.id;
+}
+
+void SerialDispatchQueue::async(TaskFunction function, ThreadQoSClass priority) {
+  taskQueue_->enqueue(std::move(function), priority);
+  scheduleDrain();
+}
+
+TaskId SerialDispatchQueue::asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay,
+                                       ThreadQoSClass priority) {
+  auto task = taskQueue_->enqueue(std::move(function), std::chrono::steady_clock::now() + delay, priority);
+  scheduleTimer(delay);
+  return task.id;
+}
+
+void SerialDispatchQueue::asyncWithDeadline(TaskFunction function, std::chrono::steady_clock::duration deadline) {
+  taskQueue_->enqueueWithDeadline(std::move(function), std::chrono::steady_clock::now() + deadline);
+  scheduleDrain();
+}
+
+bool SerialDispatchQueue::tryAsync(TaskFunction&& function) {
+  if (taskQueue_->tryEnqueue(std::move(function)).id == 0) {
+    return false;
+  }
+  scheduleDrain();
+  return true;
+}
+
+bool SerialDispatchQueue::tryAsync(TaskFunction&& function, TaskFunction onSpaceAvailable) {
+  if (taskQueue_->tryEnqueue(std::move(function), std::move(onSpaceAvailable)).id == 0) {
+    return false;
+  }
+  scheduleDrain();
+  return true;
+}
+
+void SerialDispatchQueue::asyncBatch(std::vector<TaskFunction> functions) {
+  taskQueue_->enqueueBatch(std::move(functions));
+  scheduleDrain();
+}
+
+TaskId SerialDispatchQueue::asyncBatchAfter(std::vector<TaskFunction> functions,
+                                            std::chrono::steady_clock::duration delay) {
+  auto task = taskQueue_->enqueueBatch(std::move(functions), delay);
+  scheduleTimer(delay);
+  return task.id;
+}
+
+void SerialDispatchQueue::cancel(TaskId taskId) {
+  // 目标队列中对应的唤醒任务保留，到期时只会触发一次空的排空
+  taskQueue_->cancel(taskId);
+}
+
+bool SerialDispatchQueue::isCurrent() const { return this == getCurrent(); }
+
+void SerialDispatchQueue::fullTeardown() { taskQueue_->dispose(); }
+
+bool SerialDispatchQueue::isDisposed() const { return taskQueue_->isDisposed(); }
+
+void SerialDispatchQueue::setListener(const std::shared_ptr<IQueueListener>& listener) {
+  taskQueue_->setListener(listener);
+}
+
+std::shared_ptr<IQueueListener> SerialDispatchQueue::getListener() const { return taskQueue_->getListener(); }
+
+void SerialDispatchQueue::setSchedulingPolicy(SchedulingPolicy policy) { taskQueue_->setSchedulingPolicy(policy); }
+
+void SerialDispatchQueue::setDeadlineMissPolicy(DeadlineMissPolicy policy) {
+  taskQueue_->setDeadlineMissPolicy(policy);
+}
+
+DeadlineStats SerialDispatchQueue::deadlineStats() const { return taskQueue_->deadlineStats(); }
+
+void SerialDispatchQueue::setCapacity(size_t capacity, OverflowPolicy policy) {
+  taskQueue_->setCapacity(capacity, policy);
+}
+
+OverflowStats SerialDispatchQueue::overflowStats() const { return taskQueue_->overflowStats(); }
+
+SerialDispatchQueue* SerialDispatchQueue::getCurrent() { return current_; }
+
+void SerialDispatchQueue::scheduleDrain() {
+  // 只有把 scheduled_ 从 false 改为 true 的线程投递，目标队列中最多一个排空任务
+  // 屏障与 drain() 结尾的屏障配对：刚入队的任务要么被排空任务看到，要么由本线程投递新的排空任务
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!scheduled_.exchange(true, std::memory_order_seq_cst)) {
+    postDrain(false);
+  }
+}
+
+void SerialDispatchQueue::postDrain(bool yield) {
+  auto self = std::static_pointer_cast<SerialDispatchQueue>(shared_from_this());
+  TaskFunction drainTask([ticket = DrainTicket(self)]() { ticket.run(); });
+
+  // 排空任务被阻塞或丢弃会使本队列停止执行，不受目标队列容量的限制
+  auto previousExempt = TaskQueue::setThreadCapacityExempt(true);
+  if (yield) {
+    // 线程池工作线程内的 async 进入本线程的 next 槽位，会被立即接着执行而起不到让出的作用；
+    // 零延迟的 asyncAfter 总是追加到目标队列共享就绪队列的尾部，排在其他队列的排空任务之后
+    target_->asyncAfter(std::move(drainTask), std::chrono::steady_clock::duration::zero());
+  } else {
+    target_->async(std::move(drainTask));
+  }
+  TaskQueue::setThreadCapacityExempt(previousExempt);
+}
+
+void SerialDispatchQueue::drainDropped() {
+  // 提交时不会因容量被丢弃，这里是已排队的排空任务被 DropOldest 挤出，或目标队列已销毁
+  scheduled_.store(false, std::memory_order_seq_cst);
+  // 目标队列已销毁时重新投递的任务会被立即丢弃，同一线程上不再重复投递，留给之后的提交处理
+  if (reposting_ || taskQueue_->isDisposed()) {
+    return;
+  }
+  reposting_ = true;
+  scheduleDrain();
+  reposting_ = false;
+}
+
+void SerialDispatchQueue::timerFired() {
+  timerFired_.store(true, std::memory_order_seq_cst);
+  scheduleDrain();
+}
+
+void SerialDispatchQueue::scheduleTimer(std::chrono::steady_clock::duration delay) {
+  // 唤醒任务在延迟任务入队之后计算到期时间，因此不会早于延迟任务到期
+  // 延迟任务不会被 DropOldest 挤出，提交时豁免容量限制即可保证唤醒任务不被丢弃
+  auto self = std::static_pointer_cast<SerialDispatchQueue>(shared_from_this());
+  auto previousExempt = TaskQueue::setThreadCapacityExempt(true);
+  target_->asyncAfter(
+      [weak = std::weak_ptr<SerialDispatchQueue>(self)]() {
+        if (auto queue = weak.lock()) {
+          queue->timerFired();
+        }
+      },
+      delay);
+  TaskQueue::setThreadCapacityExempt(previousExempt);
+}
+
+void SerialDispatchQueue::drain() {
+  // 之后到期的唤醒任务会重新设置标记，由结尾的检查处理
+  timerFired_.store(false, std::memory_order_seq_cst);
+
+  auto* previousCurrent = current_;
+  current_ = this;
+  // 本队列的任务向本队列提交时不受容量限制（排空期间没有其他线程执行本队列的任务）
+  auto* previousWorkerQueue = TaskQueue::setThreadWorkerQueue(taskQueue_.get());
+
+  // 一次最多执行 maxBatchSize_ 个任务；队列为空时 runNextTasks 返回 0（并通知监听器队列已空）
+  size_t budget = maxBatchSize_;
+  while (budget != 0) {
+    auto ranTasks = taskQueue_->runNextTasks(std::chrono::steady_clock::now(), budget);
+    if (ranTasks == 0) {
+      break;
+    }
+    budget -= std::min(ranTasks, budget);
+  }
+
+  current_ = previousCurrent;
+  TaskQueue::setThreadWorkerQueue(previousWorkerQueue);
+
+  if (budget == 0 && !taskQueue_->isDisposed()) {
+    // 用完本次配额：保持 scheduled_，重新排到目标队列末尾，让出线程给其他队列
+    postDrain(true);
+    return;
+  }
+
+  // 先清除标记再检查是否有新任务：提交者要么看到 false 自行投递，要么其任务被这里看到
+  scheduled_.store(false, std::memory_order_seq_cst);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (taskQueue_->pendingTaskCount() != 0 || timerFired_.load(std::memory_order_seq_cst)) {
+    scheduleDrain();
+  }
+}
+
+}  // namespace dispatch
@@ -0,0 +1,160 @@
+/**
+ * @file SlabAllocator.cpp
+ * @brief 定长对象的 slab 分配器实现
+ */
+
+#include "dispatcher/SlabAllocator.h"
+
+#include <cassert>
+#include <new>
+
+namespace dispatch {
+
+namespace {
+
+constexpr size_t kObjectAlignment = alignof(std::max_align_t);
+
+constexpr size_t alignUp(size_t value, size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+}  // namespace
+
+SlabAllocator::SlabAllocator(size_t objectSize, size_t slabSize)
+    : objectSize_(alignUp(objectSize < sizeof(FreeObject) ? sizeof(FreeObject) : objectSize, kObjectAlignment)),
+      slabSize_(slabSize) {
+  assert((slabSize & (slabSize - 1)) == 0 && "Slab size must be a power of two");
+  objectsPerSlab_ = (slabSize_ - alignUp(sizeof(Slab), kObjectAlignment)) / objectSize_;
+  assert(objectsPerSlab_ > 0 && "Slab size is too small for the object size");
+}
+
+SlabAllocator::~SlabAllocator() {
+  SlabList* lists[] = {&partial_, &full_, &empty_};
+  for (auto* list : lists) {
+    while (list->head != nullptr) {
+      auto* slab = list->head;
+      unlink(*list, slab);
+      releaseSlab(slab);
+    }
+  }
+}
+
+void* SlabAllocator::allocate() {
+  // 优先使用部分使用的 slab，其次复用空闲 slab，最后才向系统申请
+  Slab* slab = partial_.head;
+  if (slab == nullptr) {
+    slab = empty_.head;
+    if (slab != nullptr) {
+      unlink(empty_, slab);
+    } else {
+      slab = createSlab();
+    }
+    push(partial_, slab);
+  }
+
+  auto* object = slab->freeList;
+  slab->freeList = object->next;
+  slab->used++;
+  objectsInUse_++;
+
+  if (slab->used == objectsPerSlab_) {
+    unlink(partial_, slab);
+    push(full_, slab);
+  }
+  return object;
+}
+
+void SlabAllocator::deallocate(void* object) {
+  auto* slab = slabOf(object);
+  auto* freeObject = static_cast<FreeObject*>(object);
+  freeObject->next = slab->freeList;
+  slab->freeList = freeObject;
+  objectsInUse_--;
+
+  if (slab->used-- == objectsPerSlab_) {
+    unlink(full_, slab);
+    push(partial_, slab);
+  }
+
+  if (slab->used == 0) {
+    unlink(partial_, slab);
+    push(empty_, slab);
+    trim();
+  }
+}
+
+void SlabAllocator::setMaxRetainedSlabs(size_t maxRetainedSlabs) {
+  maxRetainedSlabs_ = maxRetainedSlabs;
+  trim();
+}
+
+AllocatorStats SlabAllocator::stats() const {
+  AllocatorStats stats;
+  stats.slabsInUse = partial_.count + full_.count;
+  stats.slabsRetained = empty_.count;
+  stats.objectsInUse = objectsInUse_;
+  stats.bytesRetained = (stats.slabsInUse + stats.slabsRetained) * slabSize_;
+  stats.systemAllocations = systemAllocations_;
+  stats.systemReleases = systemReleases_;
+  return stats;
+}
+
+SlabAllocator::Slab* SlabAllocator::slabOf(void* object) const {
+  return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(object) & ~(static_cast<uintptr_t>(slabSize_) - 1));
+}
+
+SlabAllocator::Slab* SlabAllocator::createSlab() {
+  // slab 按自身大小对齐，对象地址取整即可定位所属 slab
+  auto* memory = static_cast<char*>(::operator new(slabSize_, std::align_val_t(slabSize_)));
+  auto* slab = new (memory) Slab();
+  systemAllocations_++;
+
+  // 将所有对象串成空闲链表（按地址顺序，分配时局部性更好）
+  auto* first = memory + alignUp(sizeof(Slab), kObjectAlignment);
+  FreeObject* next = nullptr;
+  for (size_t i = objectsPerSlab_; i > 0; --i) {
+    auto* object = reinterpret_cast<FreeObject*>(first + (i - 1) * objectSize_);
+    object->next = next;
+    next = object;
+  }
+  slab->freeList = next;
+  return slab;
+}
+
+void SlabAllocator::releaseSlab(Slab* slab) {
+  slab->~Slab();
+  ::operator delete(static_cast<void*>(slab), std::align_val_t(slabSize_));
+  systemReleases_++;
+}
+
+void SlabAllocator::trim() {
+  while (empty_.count > maxRetainedSlabs_) {
+    auto* slab = empty_.head;
+    unlink(empty_, slab);
+    releaseSlab(slab);
+  }
+}
+
+void SlabAllocator::push(SlabList& list, Slab* slab) {
+  slab->prev = nullptr;
+  slab->next = list.head;
+  if (list.head != nullptr) {
+    list.head->prev = slab;
+  }
+  list.head = slab;
+  list.count++;
+}
+
+void SlabAllocator::unlink(SlabList& list, Slab* slab) {
+  if (slab->prev != nullptr) {
+    slab->prev->next = slab->next;
+  } else {
+    list.head = slab->next;
+  }
+  if (slab->next != nullptr) {
+    slab->next->prev = slab->prev;
+  }
+  slab->prev = nullptr;
+  slab->next = nullptr;
+  list.count--;
+}
+
+}  // namespace dispatch
@@ -5,75 +5,490 @@
 
 #include "dispatcher/TaskQueue.h"
 
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <new>
+#include <utility>
+#include <vector>
+
 namespace dispatch {
 
-TaskQueue::Task::Task(TaskId id, DispatchFunction function, std::chrono::steady_clock::time_point executeTime,
+// 当前线程的等待组，见 TaskQueue::setThreadWaitGroup
+static thread_local size_t currentWaitGroup_ = 0;
+
+// 当前线程正在执行的任务是否在超过截止时间后才开始，见 TaskQueue::currentTaskMissedDeadline
+static thread_local bool currentTaskMissedDeadline_ = false;
+
+// 当前线程作为工作线程所属的队列，见 TaskQueue::setThreadWorkerQueue
+static thread_local const TaskQueue* currentWorkerQueue_ = nullptr;
+
+// 当前线程的提交是否不受容量限制，见 TaskQueue::setThreadCapacityExempt
+static thread_local bool capacityExempt_ = false;
+
+TaskQueue::Task::Task(TaskId id, TaskFunction function, std::chrono::steady_clock::time_point executeTime,
                       bool isBarrier)
     : id(id), function(std::move(function)), executeTime(executeTime), isBarrier(isBarrier) {}
 
 TaskQueue::TaskQueue() : disposed_(false) {}
 
-TaskQueue::~TaskQueue() { dispose(); }
+TaskQueue::~TaskQueue() {
+  dispose();
+
+  while (freeWaiters_ != nullptr) {
+    delete std::exchange(freeWaiters_, freeWaiters_->nextWoken);
+  }
+}
 
 void TaskQueue::dispose() {
   if (!disposed_) {
     disposed_ = true;
 
-    // 清空任务队列
-    std::deque<Task> toDelete;
+    // 清空任务队列（包括时间轮中的延迟任务）
+    // 任务函数移出后在锁外销毁，避免在持有锁时执行任务持有资源的析构
+    std::vector<TaskFunction> toDelete;
+    std::deque<TaskFunction> callbacks;
     mutex_.lock();
-    toDelete.swap(tasks_);
+    drainSubmissions(true);
+    auto collect = [this, &toDelete](Task* task) {
+      toDelete.push_back(std::move(task->function));
+      releaseTask(task);
+    };
+    while (!tasks_.empty()) {
+      auto* task = tasks_.front();
+      tasks_.pop_front();
+      collect(task);
+    }
+    timers_.clear(collect);
+    index_.clear();
+    queuedTasks_ = 0;
+    callbacks.swap(spaceCallbacks_);
+
+    // 唤醒所有空闲线程
+    while (idleWaiters_ != nullptr) {
+      wakeWaiter(idleWaiters_);
+    }
+    auto* woken = std::exchange(wokenWaiters_, nullptr);
+    bool deliver = shouldDeliverListenerEvents();
     mutex_.unlock();
 
-    // 唤醒所有等待的线程
+    signalWaiters(woken);
+    toDelete.clear();
+    callbacks.clear();
+    if (deliver) {
+      deliverListenerEvents();
+    }
+
+    // 唤醒所有等待屏障或并发数的线程，以及等待空间的生产者（它们的任务被丢弃）
     condition_.notify_all();
+    spaceCondition_.notify_all();
   }
 }
 
-void TaskQueue::sync(const DispatchFunction& function) {
+void TaskQueue::sync(const TaskFunction& function) {
   // sync 通过 barrier 实现，确保同步执行
   barrier(function);
 }
 
-void TaskQueue::async(DispatchFunction function) { enqueue(std::move(function)); }
+void TaskQueue::async(TaskFunction function) { enqueue(std::move(function)); }
 
-TaskId TaskQueue::asyncAfter(DispatchFunction function, std::chrono::steady_clock::duration delay) {
+TaskId TaskQueue::asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay) {
   return enqueue(std::move(function), delay).id;
 }
 
-EnqueuedTask TaskQueue::enqueue(DispatchFunction function) {
-  // 立即执行 = 当前时间
-  return enqueue(std::move(function), std::chrono::steady_clock::now());
+void TaskQueue::asyncBatch(std::vector<TaskFunction> functions) { enqueueBatch(std::move(functions)); }
+
+TaskId TaskQueue::asyncBatchAfter(std::vector<TaskFunction> functions, std::chrono::steady_clock::duration delay) {
+  return enqueueBatch(std::move(functions), delay).id;
+}
+
+void TaskQueue::async(TaskFunction function, ThreadQoSClass priority) { enqueue(std::move(function), priority); }
+
+TaskId TaskQueue::asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay,
+                             ThreadQoSClass priority) {
+  return enqueue(std::move(function), std::chrono::steady_clock::now() + delay, priority).id;
 }
 
-EnqueuedTask TaskQueue::enqueue(DispatchFunction function, std::chrono::steady_clock::duration delay) {
+void TaskQueue::asyncWithDeadline(TaskFunction function, std::chrono::steady_clock::duration deadline) {
+  enqueueWithDeadline(std::move(function), std::chrono::steady_clock::now() + deadline);
+}
+
+bool TaskQueue::tryAsync(TaskFunction&& function) { return tryEnqueue(std::move(function)).id != 0; }
+
+bool TaskQueue::tryAsync(TaskFunction&& function, TaskFunction onSpaceAvailable) {
+  return tryEnqueue(std::move(function), std::move(onSpaceAvailable)).id != 0;
+}
+
+EnqueuedTask TaskQueue::enqueue(TaskFunction function) {
+  // 立即执行：直接追加到就绪队列，不需要读取时钟
+  return enqueue(std::move(function), kImmediate, kThreadQoSClassNormal);
+}
+
+EnqueuedTask TaskQueue::enqueue(TaskFunction function, std::chrono::steady_clock::duration delay) {
   // 延迟执行 = 当前时间 + 延迟
-  return enqueue(std::move(function), std::chrono::steady_clock::now() + delay);
+  return enqueue(std::move(function), std::chrono::steady_clock::now() + delay, kThreadQoSClassNormal);
 }
 
-TaskId TaskQueue::insertTask(DispatchFunction&& function, std::chrono::steady_clock::time_point executeTime,
-                             bool isBarrier) {
-  // 生成唯一的任务ID
-  auto id = ++taskIdCounter_;
+EnqueuedTask TaskQueue::enqueue(TaskFunction function, ThreadQoSClass priority) {
+  return enqueue(std::move(function), kImmediate, priority);
+}
+
+EnqueuedTask TaskQueue::enqueue(TaskFunction function, std::chrono::steady_clock::time_point executeTime) {
+  return enqueue(std::move(function), executeTime, kThreadQoSClassNormal);
+}
+
+TaskQueue::Task* TaskQueue::allocateTask(TaskId id, TaskFunction&& function,
+                                         std::chrono::steady_clock::time_point executeTime, bool isBarrier) {
+  return ::new (taskAllocator_.allocate()) Task(id, std::move(function), executeTime, isBarrier);
+}
+
+void TaskQueue::releaseTask(Task* task) {
+  task->~Task();
+  taskAllocator_.deallocate(task);
+}
+
+TaskId TaskQueue::insertTask(TaskId id, TaskFunction&& function, std::chrono::steady_clock::time_point executeTime,
+                             bool isBarrier, bool delayed, ThreadQoSClass priority,
+                             std::chrono::steady_clock::time_point deadline) {
+  auto* task = allocateTask(id, std::move(function), executeTime, isBarrier);
+  task->priority = std::min(priority, kThreadQoSClassMax);
+
+  // 屏障任务只在内部使用，不需要支持取消，也不计入容量
+  if (!isBarrier) {
+    index_.insert(id, task);
+    queuedTasks_++;
+  }
+
+  // 未到期的任务放入时间轮，O(1) 插入
+  if (delayed) {
+    task->delayed = true;
+    timers_.insert(task);
+    return id;
+  }
+
+  // 执行时间只在时间轮中使用，就绪任务的同一存储改为保存截止时间（切换联合体的活动成员）
+  // 已到期的任务直接追加到其优先级通道（或按截止时间排序的堆）
+  task->deadline = deadline;
+  tasks_.push_back(task);
+  return id;
+}
+
+std::cv_status TaskQueue::waitForWork(std::unique_lock<std::mutex>& lock,
+                                      std::chrono::steady_clock::time_point maxTime, bool timerLeader) {
+  // 已经超时的调用（例如 runNextTask()）不进入空闲栈，避免占用本应发给空闲线程的唤醒
+  if (maxTime <= std::chrono::steady_clock::now()) {
+    return std::cv_status::timeout;
+  }
+
+  // 取一个可复用的等待者对象，压入空闲栈（栈顶的线程最先被唤醒）
+  auto* waiter = freeWaiters_;
+  if (waiter != nullptr) {
+    freeWaiters_ = waiter->nextWoken;
+  } else {
+    waiter = new Waiter();
+  }
+  waiter->claimed = false;
+  waiter->group = currentWaitGroup_;
+  {
+    std::lock_guard<std::mutex> waiterLock(waiter->mutex);
+    waiter->signalled = false;
+  }
+
+  waiter->next = idleWaiters_;
+  if (idleWaiters_ != nullptr) {
+    idleWaiters_->prev = waiter;
+  }
+  idleWaiters_ = waiter;
+
+  if (timerLeader) {
+    timerLeader_ = waiter;
+    timerLeaderDeadline_ = maxTime;
+  }
+
+  // 先登记为等待者，再检查提交队列：
+  // 生产者发布任务后会检查等待者数量，两侧的全屏障保证至少有一方看到对方
+  waiters_.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
 
-  // 创建任务对象
-  Task task(id, std::move(function), executeTime, isBarrier);
+  auto result = std::cv_status::no_timeout;
+  bool signalled = false;
+  if (!submissions_.hasPublished()) {
+    // 在自己的条件变量上等待，不持有 mutex_
+    lock.unlock();
+    {
+      std::unique_lock<std::mutex> waiterLock(waiter->mutex);
+      if (maxTime == kForever) {
+        waiter->condition.wait(waiterLock, [waiter]() { return waiter->signalled; });
+        signalled = true;
+      } else {
+        signalled = waiter->condition.wait_until(waiterLock, maxTime, [waiter]() { return waiter->signalled; });
+      }
+    }
+    lock.lock();
+    if (!signalled && !waiter->claimed) {
+      result = std::cv_status::timeout;
+    }
+  }
+
+  if (waiter->claimed && !signalled && !unlinkWoken(waiter)) {
+    // 超时与唤醒同时发生：唤醒方已取走 wokenWaiters_，释放 mutex_ 后才会设置 signalled。
+    // 在此之前不能复用等待者，否则唤醒方读取 nextWoken 时会与复用者竞争，跳过链表中的其他等待者
+    lock.unlock();
+    {
+      std::unique_lock<std::mutex> waiterLock(waiter->mutex);
+      waiter->condition.wait(waiterLock, [waiter]() { return waiter->signalled; });
+    }
+    lock.lock();
+  }
+
+  waiters_.fetch_sub(1, std::memory_order_relaxed);
+
+  if (waiter->claimed) {
+    // 被唤醒的线程不再计入待运行数量；与超时同时发生时按唤醒处理，避免丢失任务
+    pendingWakeups_--;
+    result = std::cv_status::no_timeout;
+  } else {
+    unlinkWaiter(waiter);
+  }
+
+  if (timerLeader_ == waiter) {
+    timerLeader_ = nullptr;
+  }
+
+  waiter->nextWoken = freeWaiters_;
+  freeWaiters_ = waiter;
+  return result;
+}
+
+std::cv_status TaskQueue::waitForStateChange(std::unique_lock<std::mutex>& lock,
+                                             std::chrono::steady_clock::time_point maxTime) {
+  conditionWaiters_++;
+  auto result = std::cv_status::no_timeout;
+  if (maxTime == kForever) {
+    condition_.wait(lock);
+  } else {
+    result = condition_.wait_until(lock, maxTime);
+  }
+  conditionWaiters_--;
+  return result;
+}
 
-  // 按执行时间排序插入（二分查找插入位置）
-  // 相同执行时间的任务按ID顺序（先入先出）
-  auto it = std::upper_bound(tasks_.begin(), tasks_.end(), task, [](const Task& a, const Task& b) {
-    if (a.executeTime == b.executeTime) {
-      return a.id < b.id;
+void TaskQueue::wakeWorkers() {
+  if (idleWaiters_ == nullptr) {
+    return;
+  }
+
+  // 唤醒数量 = min(就绪任务数, 剩余并发数) - 已唤醒但尚未运行的线程数
+  auto capacity = currentRunningTasks_ < maxConcurrentTasks_ ? maxConcurrentTasks_ - currentRunningTasks_ : 0;
+  auto wanted = std::min(tasks_.size(), capacity);
+  while (pendingWakeups_ < wanted && idleWaiters_ != nullptr) {
+    wakeWaiter(idleWaiters_);
+  }
+}
+
+void TaskQueue::wakeTimerLeader(std::chrono::steady_clock::time_point executeTime) {
+  if (timerLeader_ != nullptr) {
+    // 新任务比 leader 的等待截止时间更早到期，唤醒 leader 重新计算
+    if (executeTime != kImmediate && executeTime < timerLeaderDeadline_ && !timerLeader_->claimed) {
+      wakeWaiter(timerLeader_);
+    }
+    return;
+  }
+
+  // 没有 leader，唤醒一个空闲线程接任
+  if (!timers_.empty() && idleWaiters_ != nullptr) {
+    wakeWaiter(idleWaiters_);
+  }
+}
+
+void TaskQueue::wakeWaiter(Waiter* waiter) {
+  unlinkWaiter(waiter);
+  waiter->claimed = true;
+  waiter->nextWoken = wokenWaiters_;
+  wokenWaiters_ = waiter;
+  pendingWakeups_++;
+}
+
+bool TaskQueue::unlinkWoken(Waiter* waiter) {
+  for (auto** link = &wokenWaiters_; *link != nullptr; link = &(*link)->nextWoken) {
+    if (*link == waiter) {
+      *link = waiter->nextWoken;
+      return true;
     }
-    return a.executeTime < b.executeTime;
+  }
+  return false;
+}
+
+void TaskQueue::signalWaiters(Waiter* waiters) {
+  while (waiters != nullptr) {
+    // 设置标志之后等待者可能立即返回并被复用，必须先读取后继
+    auto* waiter = waiters;
+    waiters = waiter->nextWoken;
+
+    {
+      std::lock_guard<std::mutex> waiterLock(waiter->mutex);
+      waiter->signalled = true;
+    }
+    // 在锁外通知，被唤醒的线程不会阻塞在 Waiter::mutex 上
+    waiter->condition.notify_one();
+  }
+}
+
+void TaskQueue::unlinkWaiter(Waiter* waiter) {
+  if (waiter->prev != nullptr) {
+    waiter->prev->next = waiter->next;
+  } else {
+    idleWaiters_ = waiter->next;
+  }
+  if (waiter->next != nullptr) {
+    waiter->next->prev = waiter->prev;
+  }
+  waiter->prev = nullptr;
+  waiter->next = nullptr;
+}
+
+void TaskQueue::notifySubmission() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiters_.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+
+  // 等待者在持有锁期间完成登记和检查，获取锁后它一定已在空闲栈中等待
+  // 先取出已发布的任务，再按就绪任务数量唤醒
+  Waiter* woken;
+  bool deliver;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    drainSubmissions(false);
+    wakeWorkers();
+    woken = std::exchange(wokenWaiters_, nullptr);
+    deliver = shouldDeliverListenerEvents();
+  }
+  signalWaiters(woken);
+  if (deliver) {
+    deliverListenerEvents();
+  }
+}
+
+void TaskQueue::drainSubmissions(bool waitForPending) {
+  auto onTask = [this](TaskId id, TaskFunction&& function) {
+    insertTask(id, std::move(function), kImmediate, false, false);
+  };
+
+  size_t count;
+  if (waitForPending) {
+    count = submissions_.popUntil(submissions_.enqueuePosition(), onTask);
+  } else {
+    count = submissions_.popPublished(onTask);
+  }
+
+  if (count != 0) {
+    markNonEmpty();
+  }
+}
+
+void TaskQueue::markNonEmpty() {
+  if (empty_) {
+    empty_ = false;
+    queueListenerEvent(true);
+  }
+}
+
+void TaskQueue::queueListenerEvent(bool nonEmpty) {
+  if (listener_ == nullptr) {
+    return;
+  }
+
+  if (pendingListenerEvents_ == 0) {
+    firstListenerEventNonEmpty_ = nonEmpty;
+    pendingListenerEvents_ = 1;
+    return;
+  }
+
+  // 事件总是空/非空交替出现，只需记录数量和第一个事件的类型；
+  // 与最后一个待投递事件相同的事件（监听器曾被临时移除时可能出现）直接合并
+  bool lastNonEmpty = firstListenerEventNonEmpty_ != ((pendingListenerEvents_ - 1) % 2 == 1);
+  if (lastNonEmpty != nonEmpty) {
+    pendingListenerEvents_++;
+  }
+}
+
+bool TaskQueue::shouldDeliverListenerEvents() const {
+  return pendingListenerEvents_ != 0 && !deliveringListenerEvents_;
+}
+
+void TaskQueue::deliverListenerEvents(std::unique_lock<std::mutex>& lock) {
+  if (!shouldDeliverListenerEvents()) {
+    return;
+  }
+
+  deliveringListenerEvents_ = true;
+  while (pendingListenerEvents_ != 0) {
+    bool nonEmpty = firstListenerEventNonEmpty_;
+    firstListenerEventNonEmpty_ = !nonEmpty;
+    pendingListenerEvents_--;
+    auto listener = listener_;
+
+    // 在锁外调用回调，回调中可以再次提交、取消任务或修改监听器
+    lock.unlock();
+    if (listener != nullptr) {
+      if (nonEmpty) {
+        listener->onQueueNonEmpty();
+      } else {
+        listener->onQueueEmpty();
+      }
+    }
+    lock.lock();
+  }
+  deliveringListenerEvents_ = false;
+}
+
+void TaskQueue::deliverListenerEvents() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  deliverListenerEvents(lock);
+}
+
+void TaskQueue::promoteExpiredTimers(std::chrono::steady_clock::time_point now) {
+  // 时间轮按 (executeTime, id) 顺序批量交出到期任务，各自进入其优先级通道
+  timers_.expire(now, [this](Task* task) {
+    task->delayed = false;
+    task->deadline = kNoDeadline;
+    tasks_.push_back(task);
   });
+}
 
-  tasks_.emplace(it, std::move(task));
+void TaskQueue::purgeCancelledTasks() {
+  // 只回收队首（选中通道的头部），其他通道头部的墓碑在该通道被选中时回收
+  while (!tasks_.empty() && tasks_.front()->cancelled) {
+    auto* task = tasks_.front();
+    tasks_.pop_front();
+    releaseTask(task);
+  }
+}
 
-  return id;
+EnqueuedTask TaskQueue::enqueue(TaskFunction function, std::chrono::steady_clock::time_point executeTime,
+                                ThreadQoSClass priority) {
+  return enqueueTask(std::move(function), executeTime, priority, kNoDeadline);
+}
+
+EnqueuedTask TaskQueue::enqueueWithDeadline(TaskFunction function, std::chrono::steady_clock::time_point deadline,
+                                            ThreadQoSClass priority) {
+  return enqueueTask(std::move(function), kImmediate, priority, deadline);
+}
+
+EnqueuedTask TaskQueue::tryEnqueue(TaskFunction&& function) {
+  // 空的回调表示只拒绝、不登记
+  TaskFunction onSpaceAvailable;
+  return enqueueTask(std::move(function), kImmediate, kThreadQoSClassNormal, kNoDeadline, &onSpaceAvailable);
+}
+
+EnqueuedTask TaskQueue::tryEnqueue(TaskFunction&& function, TaskFunction onSpaceAvailable) {
+  return enqueueTask(std::move(function), kImmediate, kThreadQoSClassNormal, kNoDeadline, &onSpaceAvailable);
 }
 
-EnqueuedTask TaskQueue::enqueue(DispatchFunction function, std::chrono::steady_clock::time_point executeTime) {
+EnqueuedTask TaskQueue::enqueueTask(TaskFunction&& function, std::chrono::steady_clock::time_point executeTime,
+                                    ThreadQoSClass priority, std::chrono::steady_clock::time_point deadline,
+                                    TaskFunction* onSpaceAvailable) {
   EnqueuedTask enqueuedTask;
 
   // 队列已销毁，直接返回
@@ -81,69 +496,237 @@ EnqueuedTask TaskQueue::enqueue(DispatchFunction function, std::chrono::steady_c
     return enqueuedTask;
   }
 
+  // 生成唯一的任务ID
+  enqueuedTask.id = taskIdCounter_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  // 快速路径：立即执行的任务写入无锁提交队列，不获取互斥锁
+  // 设置了监听器时走加锁路径，保证 onQueueNonEmpty 在提交时产生，而不是推迟到工作线程取出任务时；
+  // 设置了容量时走加锁路径，在插入前检查容量；
+  // 提交队列中的任务都进入默认优先级的通道且没有截止时间，其他任务同样走加锁路径
+  if (executeTime == kImmediate && priority == kThreadQoSClassNormal && deadline == kNoDeadline &&
+      !lockedSubmissions_.load(std::memory_order_acquire) && submissions_.tryPush(enqueuedTask.id, function)) {
+    // 在 notifySubmission() 的全屏障之后读取首任务标记，与 retireWorkerIfIdle() 的屏障配对
+    notifySubmission();
+    enqueuedTask.isFirst = first_.load(std::memory_order_relaxed) && first_.exchange(false);
+    return enqueuedTask;
+  }
+
+  // 只有指定了执行时间的任务才需要读取时钟判断是否已到期
+  bool delayed = executeTime != kImmediate && executeTime > std::chrono::steady_clock::now();
+
+  Waiter* woken;
+  bool deliver;
+  bool notify;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    // 因队列已满而被丢弃的任务在释放锁之后销毁
+    std::vector<TaskFunction> evicted;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // 先取出已提交到无锁队列的任务，保证同一生产者的任务顺序
+    drainSubmissions(true);
 
-    // 插入任务
-    enqueuedTask.id = insertTask(std::move(function), executeTime, false);
+    if (capacity_.load(std::memory_order_relaxed) != 0 && reserveCapacity(lock, 1, onSpaceAvailable, &evicted) == 0) {
+      // 队列已满，新任务被拒绝或丢弃
+      enqueuedTask.id = 0;
+    } else {
+      // 插入任务
+      insertTask(enqueuedTask.id, std::move(function), executeTime, false, delayed, priority, deadline);
 
-    // 标记是否为第一个任务（用于启动工作线程）
-    enqueuedTask.isFirst = first_;
-    first_ = false;
+      // 标记是否为第一个任务（用于启动工作线程）
+      enqueuedTask.isFirst = first_.load(std::memory_order_relaxed) && first_.exchange(false);
 
-    // 如果队列从空变为非空，通知监听器
-    if (empty_) {
-      empty_ = false;
-      if (listener_ != nullptr) {
-        listener_->onQueueNonEmpty();
+      // 如果队列从空变为非空，记录监听器事件，释放锁后投递
+      markNonEmpty();
+
+      // 只唤醒需要的线程：就绪任务按数量唤醒，延迟任务只在影响 timer leader 时唤醒
+      if (delayed) {
+        wakeTimerLeader(executeTime);
+      } else {
+        wakeWorkers();
       }
     }
+    woken = std::exchange(wokenWaiters_, nullptr);
+    deliver = shouldDeliverListenerEvents();
+    // 丢弃已排队的任务可能使屏障到达队首
+    notify = !evicted.empty() && conditionWaiters_ != 0;
   }
 
-  // 唤醒等待的工作线程
-  condition_.notify_all();
+  signalWaiters(woken);
+  if (notify) {
+    condition_.notify_all();
+  }
+  if (deliver) {
+    deliverListenerEvents();
+  }
+  return enqueuedTask;
+}
+
+EnqueuedTask TaskQueue::enqueueBatch(std::vector<TaskFunction> functions) {
+  return enqueueBatch(std::move(functions), kImmediate);
+}
+
+EnqueuedTask TaskQueue::enqueueBatch(std::vector<TaskFunction> functions, std::chrono::steady_clock::duration delay) {
+  return enqueueBatch(std::move(functions), std::chrono::steady_clock::now() + delay);
+}
+
+EnqueuedTask TaskQueue::enqueueBatch(std::vector<TaskFunction> functions,
+                                     std::chrono::steady_clock::time_point executeTime) {
+  EnqueuedTask enqueuedTask;
+
+  if (disposed_ || functions.empty()) {
+    return enqueuedTask;
+  }
+
+  // 一次分配连续的任务ID
+  auto count = static_cast<TaskId>(functions.size());
+  enqueuedTask.id = taskIdCounter_.fetch_add(count, std::memory_order_relaxed) + 1;
+
+  // 整批任务共享执行时间，只读取一次时钟
+  bool delayed = executeTime != kImmediate && executeTime > std::chrono::steady_clock::now();
+
+  Waiter* woken;
+  bool deliver;
+  bool notify;
+  {
+    // 因队列已满而被丢弃的任务在释放锁之后销毁（未入队的新任务随 functions 销毁）
+    std::vector<TaskFunction> evicted;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // 先取出已提交到无锁队列的任务，保证同一生产者的任务顺序
+    drainSubmissions(true);
+
+    // 有界队列：DropOldest 丢弃完已排队的任务后仍不够时丢弃靠前的新任务，其他策略丢弃靠后的新任务
+    auto first = static_cast<TaskId>(0);
+    auto accepted = count;
+    if (capacity_.load(std::memory_order_relaxed) != 0) {
+      accepted = static_cast<TaskId>(reserveCapacity(lock, functions.size(), nullptr, &evicted));
+      if (overflowPolicy_ == OverflowPolicy::DropOldest) {
+        first = count - accepted;
+      }
+    }
+
+    if (accepted == 0) {
+      enqueuedTask.id = 0;
+    } else {
+      // 在一次加锁内插入整批任务
+      enqueuedTask.id += first;
+      for (TaskId i = 0; i < accepted; ++i) {
+        insertTask(enqueuedTask.id + i, std::move(functions[static_cast<size_t>(first + i)]), executeTime, false,
+                   delayed);
+      }
+
+      enqueuedTask.isFirst = first_.load(std::memory_order_relaxed) && first_.exchange(false);
+      markNonEmpty();
+
+      // 整批任务只唤醒一次：就绪任务按数量唤醒，延迟任务共享同一个到期时间，只需通知 timer leader
+      if (delayed) {
+        wakeTimerLeader(executeTime);
+      } else {
+        wakeWorkers();
+      }
+    }
+    woken = std::exchange(wokenWaiters_, nullptr);
+    deliver = shouldDeliverListenerEvents();
+    notify = !evicted.empty() && conditionWaiters_ != 0;
+  }
+
+  signalWaiters(woken);
+  if (notify) {
+    condition_.notify_all();
+  }
+  if (deliver) {
+    deliverListenerEvents();
+  }
   return enqueuedTask;
 }
 
 void TaskQueue::cancel(TaskId taskId) {
+  bool notify;
+  bool deliver;
+  bool space;
   {
-    DispatchFunction toDelete;
+    TaskFunction toDelete;
     std::lock_guard<std::mutex> lock(mutex_);
+    // 任务可能还在无锁提交队列中，先移入就绪队列
+    drainSubmissions(true);
     // 移除任务（如果存在）
     toDelete = lockFreeRemoveTask(taskId);
+    // 回收墓碑可能使屏障到达队首
+    notify = conditionWaiters_ != 0;
+    deliver = shouldDeliverListenerEvents();
+    space = hasSpaceWaiters();
     // toDelete 在作用域结束时销毁
   }
 
-  condition_.notify_all();
+  if (notify) {
+    condition_.notify_all();
+  }
+  if (space) {
+    notifySpaceAvailable();
+  }
+  if (deliver) {
+    deliverListenerEvents();
+  }
 }
 
-DispatchFunction TaskQueue::lockFreeRemoveTask(TaskId taskId) {
-  // 线性搜索任务（已在锁保护下）
-  for (auto i = tasks_.begin(); i != tasks_.end(); ++i) {
-    if (i->id == taskId) {
-      auto task = std::move(*i);
-      tasks_.erase(i);
-      return std::move(task.function);
+TaskFunction TaskQueue::lockFreeRemoveTask(TaskId taskId) {
+  // 通过索引定位任务（已在锁保护下）
+  auto* task = index_.erase(taskId);
+  if (task == nullptr) {
+    return TaskFunction();
+  }
+
+  if (task->claimed) {
+    // 已被批量取出但尚未执行：与执行方竞争认领，成功则取消，节点由执行方回收
+    if (task->settled.exchange(true, std::memory_order_acq_rel)) {
+      return TaskFunction();
     }
+    return std::move(task->function);
+  }
+
+  auto function = std::move(task->function);
+  queuedTasks_--;
+
+  if (task->delayed) {
+    // 延迟任务直接从时间轮中摘除
+    timers_.remove(task);
+    releaseTask(task);
+  } else {
+    // 就绪任务标记为墓碑，到达队首时回收
+    task->cancelled = true;
+    purgeCancelledTasks();
   }
 
-  return DispatchFunction();
+  return function;
 }
 
-void TaskQueue::barrier(const DispatchFunction& function) {
+void TaskQueue::barrier(const TaskFunction& function) {
   auto executeTime = std::chrono::steady_clock::now();
 
+  auto id = taskIdCounter_.fetch_add(1, std::memory_order_relaxed) + 1;
+
   std::unique_lock<std::mutex> lock(mutex_);
 
+  // 先将已提交的任务和已到期的延迟任务移入队列，保证它们排在屏障之前
+  drainSubmissions(true);
+  promoteExpiredTimers(executeTime);
+
   // 插入一个屏障任务（空函数，仅作为占位符）
-  auto id = insertTask(DispatchFunction(), executeTime, true);
+  insertTask(id, TaskFunction(), executeTime, true, false);
+
+  // 取出提交队列时可能产生了监听器事件，等待屏障前先投递
+  deliverListenerEvents(lock);
 
   while (!tasks_.empty()) {
+    purgeCancelledTasks();
+
     // 等待条件：
     // 1. 没有正在运行的任务
     // 2. 屏障任务在队列最前面
-    if (currentRunningTasks_ != 0 || tasks_.front().id != id) {
+    if (currentRunningTasks_ != 0 || tasks_.front()->id != id) {
+      conditionWaiters_++;
       condition_.wait(lock);
+      conditionWaiters_--;
       continue;
     }
 
@@ -154,32 +737,57 @@ void TaskQueue::barrier(const DispatchFunction& function) {
     function();  // 执行用户提供的函数
 
     lock.lock();
-    auto toDelete = lockFreeRemoveTask(id);  // 移除屏障占位任务
+    // 移除屏障占位任务（屏障执行期间始终位于队首，除非队列在屏障函数中被销毁）
+    if (!tasks_.empty() && tasks_.front()->id == id) {
+      auto* task = tasks_.front();
+      tasks_.pop_front();
+      releaseTask(task);
+    }
     currentRunningTasks_--;
+
+    // 屏障之后的任务可以执行了
+    wakeWorkers();
+    auto* woken = std::exchange(wokenWaiters_, nullptr);
+    bool notify = conditionWaiters_ != 0;
     lock.unlock();
 
-    condition_.notify_all();
+    signalWaiters(woken);
+    if (notify) {
+      condition_.notify_all();
+    }
     return;
   }
 }
 
-DispatchFunction TaskQueue::nextTask(std::chrono::steady_clock::time_point maxTime, bool* shouldRun) {
-  std::unique_lock<std::mutex> lock(mutex_);
+bool TaskQueue::waitForRunnableTask(std::unique_lock<std::mutex>& lock, std::chrono::steady_clock::time_point maxTime) {
   bool hasTask = false;
 
   while (!disposed_) {
-    // 情况1：队列为空
-    if (tasks_.empty()) {
-      // 通知监听器队列已空
+    // 将无锁提交的任务和已到期的延迟任务移入队列
+    drainSubmissions(false);
+    if (!timers_.empty()) {
+      promoteExpiredTimers(std::chrono::steady_clock::now());
+    }
+    purgeCancelledTasks();
+
+    // 情况1：队列为空（没有任何待执行或延迟的任务）
+    if (tasks_.empty() && timers_.empty()) {
+      // 通知监听器队列已空（在锁外投递，投递期间状态可能变化，投递后重新检查）
       if (!empty_) {
         empty_ = true;
-        if (listener_ != nullptr) {
-          listener_->onQueueEmpty();
-        }
+        queueListenerEvent(false);
+      }
+      if (shouldDeliverListenerEvents()) {
+        deliverListenerEvents(lock);
+        continue;
+      }
+      // 外部调度器通过 interruptWait() 请求空闲线程返回
+      if (consumeInterrupt(maxTime)) {
+        break;
       }
 
       // 等待新任务或超时
-      auto result = condition_.wait_until(lock, maxTime);
+      auto result = waitForWork(lock, maxTime, false);
       if (result == std::cv_status::timeout) {
         break;  // 超时退出
       } else {
@@ -187,22 +795,31 @@ DispatchFunction TaskQueue::nextTask(std::chrono::steady_clock::time_point maxTi
       }
     }
 
-    // 情况2：已达到最大并发数
-    if (currentRunningTasks_ >= maxConcurrentTasks_) {
-      auto result = condition_.wait_until(lock, maxTime);
-      if (result == std::cv_status::timeout) {
+    // 情况2：没有已到期的任务，等待最早的延迟任务到期
+    // 只有 timer leader 等待到期时间，其余线程只等待新任务，避免多个线程同时醒来
+    if (tasks_.empty()) {
+      if (consumeInterrupt(maxTime)) {
+        break;
+      }
+      bool timerLeader = timerLeader_ == nullptr;
+      auto maxTimeToWait = timerLeader ? std::min(maxTime, timers_.nextExpiry()) : maxTime;
+
+      auto result = waitForWork(lock, maxTimeToWait, timerLeader);
+
+      // 如果是因为 maxTime 超时，退出循环
+      if (maxTimeToWait == maxTime && result == std::cv_status::timeout) {
         break;
       } else {
-        continue;
+        continue;  // 继续检查
       }
     }
 
-    // 情况3：检查队列头部的任务
-    const auto& nextTask = tasks_.front();
-
-    // 如果是屏障任务，需要等待其他任务完成
-    if (nextTask.isBarrier) {
-      auto result = condition_.wait_until(lock, maxTime);
+    // 情况3：已达到最大并发数
+    if (currentRunningTasks_ >= maxConcurrentTasks_) {
+      if (consumeInterrupt(maxTime)) {
+        break;
+      }
+      auto result = waitForStateChange(lock, maxTime);
       if (result == std::cv_status::timeout) {
         break;
       } else {
@@ -210,17 +827,17 @@ DispatchFunction TaskQueue::nextTask(std::chrono::steady_clock::time_point maxTi
       }
     }
 
-    // 如果任务的执行时间还未到
-    if (nextTask.executeTime > std::chrono::steady_clock::now()) {
-      auto maxTimeToWait = std::min(maxTime, nextTask.executeTime);
-
-      auto result = condition_.wait_until(lock, maxTimeToWait);
-
-      // 如果是因为 maxTime 超时，退出循环
-      if (maxTimeToWait == maxTime && result == std::cv_status::timeout) {
+    // 情况4：队列头部是屏障任务，需要等待其他任务完成
+    // （屏障函数可能在等待队列之外的工作，例如线程池的本地任务，因此同样响应 interruptWait）
+    if (tasks_.front()->isBarrier) {
+      if (consumeInterrupt(maxTime)) {
+        break;
+      }
+      auto result = waitForStateChange(lock, maxTime);
+      if (result == std::cv_status::timeout) {
         break;
       } else {
-        continue;  // 继续检查
+        continue;
       }
     }
 
@@ -229,19 +846,106 @@ DispatchFunction TaskQueue::nextTask(std::chrono::steady_clock::time_point maxTi
     break;
   }
 
+  // 超时或被中断时本线程不再等待，如果没有 timer leader，由其他空闲线程接任
+  if (!hasTask && !disposed_) {
+    wakeTimerLeader(kImmediate);
+  }
+  return hasTask && !disposed_;
+}
+
+TaskFunction TaskQueue::nextTask(std::chrono::steady_clock::time_point maxTime, bool* shouldRun,
+                                 std::chrono::steady_clock::time_point* deadline) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
   // 准备返回任务
-  DispatchFunction nextTaskFunction;
-  if (disposed_ || !hasTask) {
+  TaskFunction nextTaskFunction;
+  bool space = false;
+  if (!waitForRunnableTask(lock, maxTime)) {
     *shouldRun = false;
   } else {
     // 取出任务
-    nextTaskFunction = std::move(tasks_.front().function);
-    currentRunningTasks_++;
+    auto* task = tasks_.front();
     tasks_.pop_front();
+    index_.erase(task->id);
+    nextTaskFunction = std::move(task->function);
+    *deadline = task->deadline;
+    releaseTask(task);
+    currentRunningTasks_++;
+    queuedTasks_--;
+    space = hasSpaceWaiters();
+
+    // 还有剩余的就绪任务时按需唤醒更多线程；
+    // 本线程若刚卸任 timer leader，由空闲线程接任等待剩余的延迟任务
+    wakeWorkers();
+    wakeTimerLeader(kImmediate);
+  }
+
+  auto* woken = std::exchange(wokenWaiters_, nullptr);
+  bool deliver = shouldDeliverListenerEvents();
+  lock.unlock();
+  signalWaiters(woken);
+  if (space) {
+    notifySpaceAvailable();
+  }
+  if (deliver) {
+    deliverListenerEvents();
   }
   return nextTaskFunction;
 }
 
+TaskQueue::Task* TaskQueue::claimTasks(std::chrono::steady_clock::time_point maxTime, size_t maxBatch) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  Task* head = nullptr;
+  Task* tail = nullptr;
+  bool space = false;
+  if (waitForRunnableTask(lock, maxTime)) {
+    // 只有串行队列批量取出，并发队列一次取一个，避免任务堆积在单个线程上
+    size_t limit = maxConcurrentTasks_ == 1 ? std::max<size_t>(maxBatch, 1) : 1;
+    size_t claimed = 0;
+
+    // 连续取出就绪任务，遇到屏障停止（屏障需要等待本批任务执行完成）
+    while (claimed < limit && !tasks_.empty() && !tasks_.front()->isBarrier) {
+      auto* task = tasks_.front();
+      tasks_.pop_front();
+      if (task->cancelled) {
+        releaseTask(task);
+        continue;
+      }
+
+      // 节点保留在索引中，执行前仍可取消
+      task->claimed = true;
+      task->next = nullptr;
+      if (tail == nullptr) {
+        head = task;
+      } else {
+        tail->next = task;
+      }
+      tail = task;
+      claimed++;
+    }
+
+    // 整批任务只占用一个并发名额；取出的任务不再计入容量
+    currentRunningTasks_++;
+    queuedTasks_ -= claimed;
+    space = hasSpaceWaiters();
+    wakeWorkers();
+    wakeTimerLeader(kImmediate);
+  }
+
+  auto* woken = std::exchange(wokenWaiters_, nullptr);
+  bool deliver = shouldDeliverListenerEvents();
+  lock.unlock();
+  signalWaiters(woken);
+  if (space) {
+    notifySpaceAvailable();
+  }
+  if (deliver) {
+    deliverListenerEvents();
+  }
+  return head;
+}
+
 size_t TaskQueue::flush() {
   // 执行所有任务（包括未来的延迟任务）
   size_t ranTasks = 0;
@@ -261,47 +965,381 @@ size_t TaskQueue::flushUpToNow() {
   return ranTasks;
 }
 
+void TaskQueue::interruptWait() { interruptWait(currentWaitGroup_); }
+
+void TaskQueue::interruptWait(size_t group) {
+  Waiter* woken;
+  bool notify = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (interruptRequested_) {
+      return;
+    }
+    interruptRequested_ = true;
+
+    // 优先唤醒同组的线程，其次是任意线程；都优先避开 timer leader，避免延迟任务暂时无人等待
+    Waiter* sameGroup = nullptr;
+    Waiter* anyGroup = nullptr;
+    for (auto* waiter = idleWaiters_; waiter != nullptr && sameGroup == nullptr; waiter = waiter->next) {
+      if (waiter == timerLeader_) {
+        continue;
+      }
+      if (waiter->group == group) {
+        sameGroup = waiter;
+      } else if (anyGroup == nullptr) {
+        anyGroup = waiter;
+      }
+    }
+    auto* waiter = sameGroup != nullptr ? sameGroup : anyGroup != nullptr ? anyGroup : idleWaiters_;
+    if (waiter != nullptr) {
+      wakeWaiter(waiter);
+    } else {
+      // 没有等待新任务的线程时，唤醒因并发数或屏障而等待的线程
+      notify = conditionWaiters_ != 0;
+    }
+    woken = std::exchange(wokenWaiters_, nullptr);
+  }
+  signalWaiters(woken);
+  if (notify) {
+    condition_.notify_all();
+  }
+}
+
+void TaskQueue::setThreadWaitGroup(size_t group) { currentWaitGroup_ = group; }
+
+bool TaskQueue::consumeInterrupt(std::chrono::steady_clock::time_point maxTime) {
+  // 不等待的调用（例如 runNextTask()）不响应请求，留给真正进入空闲等待的线程
+  if (!interruptRequested_ || maxTime <= std::chrono::steady_clock::now()) {
+    return false;
+  }
+  interruptRequested_ = false;
+  return true;
+}
+
 bool TaskQueue::runNextTask() { return runNextTask(std::chrono::steady_clock::now()); }
 
+bool TaskQueue::retireWorkerIfIdle() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  drainSubmissions(true);
+  purgeCancelledTasks();
+  if (disposed_ || !tasks_.empty() || !timers_.empty() || currentRunningTasks_ != 0) {
+    return false;
+  }
+
+  // 加锁的入队路径在锁内读取标记，与这里串行；无锁提交不获取锁，通过屏障配对：
+  // 提交者要么看到重新设置的标记自行启动线程，要么它发布的任务在这里被看到
+  first_.store(true);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (submissions_.size() != 0 && first_.exchange(false)) {
+    // 有新提交的任务且标记未被提交者取走：本线程继续执行
+    return false;
+  }
+  return true;
+}
+
+size_t TaskQueue::runNextTasks(std::chrono::steady_clock::time_point maxTime, size_t maxBatch) {
+  auto* batch = claimTasks(maxTime, maxBatch);
+  if (batch == nullptr) {
+    return 0;
+  }
+
+  size_t ranTasks = 0;
+  DeadlineStats stats;
+  for (auto* task = batch; task != nullptr; task = static_cast<Task*>(task->next)) {
+    // 与 cancel() 竞争认领：认领失败说明任务已被取消
+    if (task->settled.exchange(true, std::memory_order_acq_rel)) {
+      continue;
+    }
+    // 队列在执行期间被销毁时，剩余的任务不再执行
+    if (disposed_) {
+      task->function = TaskFunction();
+      continue;
+    }
+
+    // 在执行下一个任务之前销毁任务，确保任务持有的资源被释放
+    if (task->deadline == kNoDeadline) {
+      task->function();
+      task->function = TaskFunction();
+    } else {
+      runTaskWithDeadline(task->function, task->deadline, &stats);
+    }
+    ranTasks++;
+  }
+
+  bool notify;
+  Waiter* woken;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (batch != nullptr) {
+      auto* task = batch;
+      batch = static_cast<Task*>(task->next);
+      // 已被取消的任务已经从索引中移除
+      index_.erase(task->id);
+      releaseTask(task);
+    }
+    addDeadlineStats(stats);
+
+    bool saturated = currentRunningTasks_ >= maxConcurrentTasks_;
+    currentRunningTasks_--;
+    if (saturated) {
+      wakeWorkers();
+    }
+    woken = std::exchange(wokenWaiters_, nullptr);
+    notify = conditionWaiters_ != 0;
+  }
+
+  signalWaiters(woken);
+  if (notify) {
+    condition_.notify_all();
+  }
+  return ranTasks;
+}
+
 bool TaskQueue::runNextTask(std::chrono::steady_clock::time_point maxTime) {
   auto shouldRun = true;
-  auto task = nextTask(maxTime, &shouldRun);
+  auto deadline = kNoDeadline;
+  auto task = nextTask(maxTime, &shouldRun, &deadline);
 
   if (shouldRun) {
-    // 执行任务
-    task();
-
-    // 在通知条件变量之前销毁任务
+    // 执行任务，并在通知条件变量之前销毁任务
     // 确保任务持有的资源被释放
-    task = DispatchFunction();
+    DeadlineStats stats;
+    if (deadline == kNoDeadline) {
+      task();
+      task = TaskFunction();
+    } else {
+      runTaskWithDeadline(task, deadline, &stats);
+    }
 
+    bool notify;
+    Waiter* woken;
     {
       std::lock_guard<std::mutex> lock(mutex_);
+      if (deadline != kNoDeadline) {
+        addDeadlineStats(stats);
+      }
+      // 并发数已满时可能有就绪任务未能唤醒线程，释放名额后补充唤醒
+      bool saturated = currentRunningTasks_ >= maxConcurrentTasks_;
       currentRunningTasks_--;
+      if (saturated) {
+        wakeWorkers();
+      }
+      woken = std::exchange(wokenWaiters_, nullptr);
+      notify = conditionWaiters_ != 0;
     }
 
-    condition_.notify_all();
+    signalWaiters(woken);
+    if (notify) {
+      condition_.notify_all();
+    }
   }
   return shouldRun;
 }
 
+void TaskQueue::runTaskWithDeadline(TaskFunction& function, std::chrono::steady_clock::time_point deadline,
+                                    DeadlineStats* stats) {
+  bool late = std::chrono::steady_clock::now() > deadline;
+  if (late && deadlineMissPolicy_.load(std::memory_order_relaxed) == DeadlineMissPolicy::Drop) {
+    function = TaskFunction();
+    stats->dropped++;
+    return;
+  }
+
+  // 任务中可能同步执行其他队列的任务（例如 flush），结束后恢复外层任务的标记
+  auto outer = std::exchange(currentTaskMissedDeadline_, late);
+  function();
+  function = TaskFunction();
+  currentTaskMissedDeadline_ = outer;
+
+  stats->completed++;
+  if (late || std::chrono::steady_clock::now() > deadline) {
+    stats->missed++;
+  }
+}
+
+void TaskQueue::addDeadlineStats(const DeadlineStats& stats) {
+  deadlineStats_.completed += stats.completed;
+  deadlineStats_.missed += stats.missed;
+  deadlineStats_.dropped += stats.dropped;
+}
+
+bool TaskQueue::currentTaskMissedDeadline() { return currentTaskMissedDeadline_; }
+
+void TaskQueue::setSchedulingPolicy(SchedulingPolicy policy) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  tasks_.earliestDeadlineFirst = policy == SchedulingPolicy::EarliestDeadlineFirst;
+}
+
+void TaskQueue::setDeadlineMissPolicy(DeadlineMissPolicy policy) {
+  deadlineMissPolicy_.store(policy, std::memory_order_relaxed);
+}
+
+DeadlineStats TaskQueue::deadlineStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return deadlineStats_;
+}
+
+void TaskQueue::setCapacity(size_t capacity, OverflowPolicy policy) {
+  bool space;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_.store(capacity, std::memory_order_relaxed);
+    overflowPolicy_ = policy;
+    lockedSubmissions_.store(capacity != 0 || listener_ != nullptr, std::memory_order_release);
+    space = hasSpaceWaiters();
+  }
+  // 扩大容量或取消限制后，等待的生产者可能可以继续
+  if (space) {
+    notifySpaceAvailable();
+  }
+}
+
+OverflowStats TaskQueue::overflowStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return overflowStats_;
+}
+
+const TaskQueue* TaskQueue::setThreadWorkerQueue(const TaskQueue* queue) {
+  return std::exchange(currentWorkerQueue_, queue);
+}
+
+bool TaskQueue::setThreadCapacityExempt(bool exempt) { return std::exchange(capacityExempt_, exempt); }
+
+size_t TaskQueue::reserveCapacity(std::unique_lock<std::mutex>& lock, size_t count, TaskFunction* onSpaceAvailable,
+                                  std::vector<TaskFunction>* evicted) {
+  auto capacity = capacity_.load(std::memory_order_relaxed);
+  if (queuedTasks_ + count <= capacity) {
+    return count;
+  }
+
+  // tryEnqueue 不阻塞也不丢弃：登记回调，由腾出空间的线程调用
+  if (onSpaceAvailable != nullptr) {
+    overflowStats_.rejected++;
+    if (*onSpaceAvailable) {
+      spaceCallbacks_.push_back(std::move(*onSpaceAvailable));
+    }
+    return 0;
+  }
+
+  // 工作线程向自己的队列提交：阻塞会等待自己，丢弃会丢掉自身产生的后续任务；豁免的提交（串行队列的排空任务）同理
+  if (currentWorkerQueue_ == this || capacityExempt_) {
+    return count;
+  }
+
+  switch (overflowPolicy_) {
+    case OverflowPolicy::Block:
+      // 在条件变量上等待（释放锁），超过容量的批量任务等队列排空后整批入队；等待期间容量可能被修改
+      overflowStats_.blocked++;
+      blockedProducers_++;
+      while (!disposed_ && capacity != 0 && queuedTasks_ + count > capacity && queuedTasks_ != 0) {
+        spaceCondition_.wait(lock);
+        capacity = capacity_.load(std::memory_order_relaxed);
+      }
+      blockedProducers_--;
+      return disposed_ ? 0 : count;
+    case OverflowPolicy::DropOldest:
+      while (queuedTasks_ + count > capacity && evictOldestTask(evicted)) {
+      }
+      break;
+    case OverflowPolicy::DropNewest:
+      break;
+  }
+
+  auto accepted = queuedTasks_ < capacity ? std::min(count, capacity - queuedTasks_) : 0;
+  overflowStats_.dropped += count - accepted;
+  return accepted;
+}
+
+bool TaskQueue::evictOldestTask(std::vector<TaskFunction>* evicted) {
+  for (auto* task = tasks_.evict(); task != nullptr; task = tasks_.evict()) {
+    // 墓碑已经不计入容量，直接回收
+    if (task->cancelled) {
+      releaseTask(task);
+      continue;
+    }
+    index_.erase(task->id);
+    evicted->push_back(std::move(task->function));
+    releaseTask(task);
+    queuedTasks_--;
+    overflowStats_.dropped++;
+    return true;
+  }
+  return false;
+}
+
+void TaskQueue::notifySpaceAvailable() {
+  std::vector<TaskFunction> callbacks;
+  size_t producers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto capacity = capacity_.load(std::memory_order_relaxed);
+    auto space = std::numeric_limits<size_t>::max();
+    if (capacity != 0) {
+      space = capacity > queuedTasks_ ? capacity - queuedTasks_ : 0;
+    }
+
+    // 空间先分给阻塞的生产者，剩余的按登记顺序分给回调
+    producers = std::min(space, blockedProducers_);
+    auto count = std::min(space - producers, spaceCallbacks_.size());
+    callbacks.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      callbacks.push_back(std::move(spaceCallbacks_.front()));
+      spaceCallbacks_.pop_front();
+    }
+  }
+
+  for (size_t i = 0; i < producers; ++i) {
+    spaceCondition_.notify_one();
+  }
+  // 回调中通常会重新提交任务，在锁外调用
+  for (auto& callback : callbacks) {
+    callback();
+  }
+}
+
 bool TaskQueue::isDisposed() const { return disposed_; }
 
 void TaskQueue::setMaxConcurrentTasks(size_t maxConcurrentTasks) {
+  Waiter* woken;
   {
     std::lock_guard<std::mutex> lock(mutex_);
     if (maxConcurrentTasks_ == maxConcurrentTasks) {
       return;
     }
     maxConcurrentTasks_ = maxConcurrentTasks;
+    wakeWorkers();
+    woken = std::exchange(wokenWaiters_, nullptr);
   }
   // 并发数变化可能允许更多任务执行
+  signalWaiters(woken);
   condition_.notify_all();
 }
 
 void TaskQueue::setListener(const std::shared_ptr<IQueueListener>& listener) {
   std::lock_guard<std::mutex> lock(mutex_);
   listener_ = listener;
+  lockedSubmissions_.store(listener != nullptr || capacity_.load(std::memory_order_relaxed) != 0,
+                           std::memory_order_release);
+}
+
+void TaskQueue::setMaxRetainedSlabs(size_t maxRetainedSlabs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  taskAllocator_.setMaxRetainedSlabs(maxRetainedSlabs);
+}
+
+AllocatorStats TaskQueue::allocatorStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return taskAllocator_.stats();
+}
+
+size_t TaskQueue::pendingTaskCount() const { return submissions_.size() + tasks_.size(); }
+
+size_t TaskQueue::pendingTaskCount(ThreadQoSClass minPriority) const {
+  size_t count = 0;
+  for (size_t lane = minPriority; lane < kPriorityLanes; ++lane) {
+    count += tasks_.lanes[lane].size();
+  }
+  return count + tasks_.deadlineCount.load(std::memory_order_relaxed);
 }
 
 std::shared_ptr<IQueueListener> TaskQueue::getListener() const {
@@ -5,26 +5,121 @@
 
 #include "dispatcher/ThreadPoolDispatchQueue.h"
 
+#include <algorithm>
 #include <cassert>
+#include <new>
+
+#include "dispatcher/ClosureAllocator.h"
 
 namespace dispatch {
 
 // 线程局部变量，用于标识当前线程所属的队列
 static thread_local ThreadPoolDispatchQueue* current_ = nullptr;
 
-ThreadPoolDispatchQueue::ThreadPoolDispatchQueue(const std::string& name, size_t threadCount)
-    : name_(name), thread_count_(threadCount) {
-  assert(threadCount > 0 && "Thread count must be greater than 0");
+// 当前工作线程在所属线程池中的索引
+static thread_local size_t current_index_ = 0;
+
+/**
+ * @brief 本地队列中的任务
+ *
+ * 工作窃取队列只保存指针，任务函数存放在从 ClosureAllocator 分配的节点中。
+ */
+struct ThreadPoolDispatchQueue::LocalTask {
+  TaskFunction function;  ///< 任务函数
+};
+
+/**
+ * @brief parallelFor 的共享状态
+ *
+ * 由调用线程和辅助任务共同持有（shared_ptr）：辅助任务可能在循环结束后才开始运行，
+ * 此时只访问本状态，发现没有剩余迭代后直接返回，不会访问调用者栈上的循环体。
+ */
+struct ThreadPoolDispatchQueue::ParallelForState {
+  size_t count;                      ///< 迭代总数
+  size_t grain;                      ///< 最小块大小
+  size_t participants;               ///< 参与的线程数（调用线程 + 辅助任务）
+  void* body;                        ///< 类型擦除后的循环体
+  ParallelForChunk run;              ///< 执行一个块的函数
+  std::atomic<size_t> next{0};       ///< 下一个未分配的迭代
+  std::atomic<size_t> completed{0};  ///< 已完成的迭代数
+  std::mutex mutex;                  ///< 保护 finished 的互斥锁
+  std::condition_variable finished;  ///< 所有迭代完成时通知调用线程
+
+  ParallelForState(size_t count, size_t grain, size_t participants, void* body, ParallelForChunk run)
+      : count(count), grain(grain), participants(participants), body(body), run(run) {}
+
+  /// 取走下一个块：剩余迭代的 1/(2P)，不小于 grain
+  bool claim(size_t& first, size_t& last) {
+    auto current = next.load(std::memory_order_relaxed);
+    while (current < count) {
+      auto remaining = count - current;
+      auto chunk = std::min(remaining, std::max(grain, remaining / (2 * participants)));
+      if (next.compare_exchange_weak(current, current + chunk, std::memory_order_relaxed)) {
+        first = current;
+        last = current + chunk;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// 不断取块执行，直到没有剩余迭代
+  void work() {
+    size_t first;
+    size_t last;
+    while (claim(first, last)) {
+      run(body, first, last);
+      // 最后一个块完成时通知调用线程（release：循环体的写入对调用线程可见）
+      if (completed.fetch_add(last - first, std::memory_order_acq_rel) + (last - first) == count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.notify_all();
+      }
+    }
+  }
+};
+
+ThreadPoolDispatchQueue::ThreadPoolDispatchQueue(const std::string& name, const ThreadPoolOptions& options)
+    : name_(name), options_(options), qos_class_(options.qosClass) {
+  assert(options.minThreads > 0 && "Thread count must be greater than 0");
+  assert(options.maxThreads >= options.minThreads && "maxThreads must not be less than minThreads");
 
-  // 设置 TaskQueue 的最大并发数与线程数一致
-  task_queue_.setMaxConcurrentTasks(threadCount);
+  // 设置 TaskQueue 的最大并发数与最大线程数一致
+  task_queue_.setMaxConcurrentTasks(options.maxThreads);
+
+  // 本地队列在线程启动前创建，窃取时可以无锁访问所有线程的队列
+  local_workers_.reserve(options.maxThreads);
+  for (size_t i = 0; i < options.maxThreads; ++i) {
+    local_workers_.push_back(std::make_unique<Worker>());
+  }
+
+  // 按布局为每个槽位分配 CPU 和 NUMA 节点，线程启动时绑定
+  if (options.placement != WorkerPlacement::None) {
+    topology_ = CpuTopology::detect();
+    auto cpus = topology_.layout(options.placement, options.cpus);
+    if (!cpus.empty()) {
+      size_t maxNode = 0;
+      for (size_t i = 0; i < options.maxThreads; ++i) {
+        auto& worker = *local_workers_[i];
+        worker.cpu = cpus[i % cpus.size()];
+        worker.node = topology_.nodeOf(worker.cpu);
+        maxNode = std::max(maxNode, worker.node);
+      }
+      node_count_ = maxNode + 1;
+    }
+  }
+
+  if (options.numaQueues && node_count_ > 1) {
+    for (size_t i = 0; i < node_count_; ++i) {
+      node_queues_.push_back(std::make_unique<NodeQueue>());
+    }
+  }
 }
 
 std::shared_ptr<ThreadPoolDispatchQueue> ThreadPoolDispatchQueue::create(const std::string& name, size_t threadCount) {
-  // 使用 new 因为构造函数是私有的
-  auto queue = std::shared_ptr<ThreadPoolDispatchQueue>(new ThreadPoolDispatchQueue(name, threadCount));
-  queue->start();
-  return queue;
+  ThreadPoolOptions options;
+  options.minThreads = threadCount;
+  options.maxThreads = threadCount;
+  return create(name, options);
 }
 
 std::shared_ptr<ThreadPoolDispatchQueue> ThreadPoolDispatchQueue::create(const std::string& name) {
@@ -36,87 +131,670 @@ std::shared_ptr<ThreadPoolDispatchQueue> ThreadPoolDispatchQueue::create(const s
   return create(name, threadCount);
 }
 
-ThreadPoolDispatchQueue::~ThreadPoolDispatchQueue() {
-  // 标记停止
-  running_ = false;
+std::shared_ptr<ThreadPoolDispatchQueue> ThreadPoolDispatchQueue::create(const std::string& name,
+                                                                         const ThreadPoolOptions& options) {
+  // 使用 new 因为构造函数是私有的
+  auto queue = std::shared_ptr<ThreadPoolDispatchQueue>(new ThreadPoolDispatchQueue(name, options));
+  queue->start();
+  return queue;
+}
+
+ThreadPoolDispatchQueue::~ThreadPoolDispatchQueue() { stop(); }
+
+void ThreadPoolDispatchQueue::start() {
+  running_ = true;
+  for (size_t i = 0; i < options_.minThreads; ++i) {
+    spawnWorker();
+  }
+}
+
+void ThreadPoolDispatchQueue::stop() {
+  // 标记停止（持有 spawn_mutex_，之后不会再创建新线程）
+  {
+    std::lock_guard<std::mutex> lock(spawn_mutex_);
+    running_ = false;
+  }
 
   // 销毁任务队列，唤醒所有等待的线程
   task_queue_.dispose();
 
-  // 等待所有工作线程结束
-  for (auto& worker : workers_) {
-    if (worker && worker->joinable()) {
-      worker->join();
+  // 等待所有工作线程结束（包括已退出但尚未回收的线程）
+  // 退出的线程需要获取 spawn_mutex_ 释放槽位，因此在锁外 join
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(spawn_mutex_);
+    for (auto& worker : local_workers_) {
+      if (worker->thread.joinable()) {
+        threads.push_back(std::move(worker->thread));
+      }
     }
   }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // 与全局队列一样，未执行的本地任务直接丢弃
+  releaseLocalTasks();
 }
 
-void ThreadPoolDispatchQueue::start() {
-  running_ = true;
-  workers_.reserve(thread_count_);
+bool ThreadPoolDispatchQueue::spawnWorker() {
+  std::lock_guard<std::mutex> lock(spawn_mutex_);
+  if (!running_ || thread_count_.load() >= options_.maxThreads) {
+    return false;
+  }
 
-  for (size_t i = 0; i < thread_count_; ++i) {
-    workers_.push_back(std::make_unique<std::thread>(&ThreadPoolDispatchQueue::workerMain, this, i));
+  // 退出的线程在同一临界区内减少线程数并释放槽位，线程数小于 maxThreads 时应有空闲槽位；
+  // 仍按槽位数量限定扫描范围。优先使用编号小的槽位，使窃取扫描的范围尽量小
+  size_t index = 0;
+  while (index < local_workers_.size() && local_workers_[index]->active) {
+    index++;
   }
+  if (index == local_workers_.size()) {
+    return false;
+  }
+  auto& worker = *local_workers_[index];
+
+  // 槽位上之前的线程已释放槽位，正在退出或已经退出
+  if (worker.thread.joinable()) {
+    worker.thread.join();
+  }
+
+  worker.active = true;
+  thread_count_.fetch_add(1);
+  spawned_count_.fetch_add(1, std::memory_order_relaxed);
+  starting_threads_.fetch_add(1);
+  if (slot_limit_.load(std::memory_order_relaxed) <= index) {
+    slot_limit_.store(index + 1);
+  }
+  worker.thread = std::thread(&ThreadPoolDispatchQueue::workerMain, this, index);
+  return true;
+}
+
+void ThreadPoolDispatchQueue::maybeGrow() {
+  // 固定大小或已达上限、有空闲线程、上一个新线程尚未开始运行时都不扩容
+  // 空闲线程以实际阻塞在全局队列上的线程为准（parked_workers_ 还包括正在执行被唤醒任务的线程）
+  if (thread_count_.load(std::memory_order_relaxed) >= options_.maxThreads || task_queue_.idleThreadCount() != 0 ||
+      starting_threads_.load(std::memory_order_relaxed) != 0) {
+    return;
+  }
+
+  auto backlog = task_queue_.pendingTaskCount() + localBacklog();
+  if (backlog == 0) {
+    if (saturated_since_.load(std::memory_order_relaxed) != 0) {
+      saturated_since_.store(0, std::memory_order_relaxed);
+    }
+    return;
+  }
+
+  // 记录积压开始的时间，积压数量或持续时间超过阈值时扩容
+  auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+                 .count();
+  auto since = saturated_since_.load(std::memory_order_relaxed);
+  if (since == 0) {
+    saturated_since_.compare_exchange_strong(since, now, std::memory_order_relaxed);
+    since = now;
+  }
+  auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.spawnLatency).count();
+  if (backlog < options_.spawnBacklog && now - since < latency) {
+    return;
+  }
+
+  // 重新开始计时，新线程仍不足以消化积压时再次扩容
+  saturated_since_.store(now, std::memory_order_relaxed);
+  spawnWorker();
+}
+
+bool ThreadPoolDispatchQueue::tryRetire(Worker& worker) {
+  // 还有任务时不退出：可能是窃取唤醒请求恰好与超时同时发生
+  if (hasLocalTasks() || task_queue_.pendingTaskCount() != 0) {
+    return false;
+  }
+
+  // 减少线程数与释放槽位在同一临界区内完成：spawnWorker 看到线程数低于上限时一定能找到空闲槽位
+  std::lock_guard<std::mutex> lock(spawn_mutex_);
+  if (!running_) {
+    return false;
+  }
+  auto count = thread_count_.load();
+  while (count > options_.minThreads) {
+    if (thread_count_.compare_exchange_weak(count, count - 1)) {
+      retired_count_.fetch_add(1, std::memory_order_relaxed);
+      worker.active = false;
+      return true;
+    }
+  }
+  return false;
+}
+
+ThreadPoolStats ThreadPoolDispatchQueue::stats() const {
+  ThreadPoolStats stats;
+  stats.threads = thread_count_.load(std::memory_order_relaxed);
+  stats.idleThreads = task_queue_.idleThreadCount();
+  stats.spawned = spawned_count_.load(std::memory_order_relaxed);
+  stats.retired = retired_count_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 void ThreadPoolDispatchQueue::workerMain(size_t threadIndex) {
   // 设置线程局部变量
   current_ = this;
+  current_index_ = threadIndex;
+  auto& worker = *local_workers_[threadIndex];
+  starting_threads_.fetch_sub(1);
+
+  // 绑定 CPU，并以 NUMA 节点作为等待组，唤醒时优先选择同一节点的线程
+  if (worker.cpu >= 0) {
+    CpuTopology::bindCurrentThread({worker.cpu});
+  } else if (!options_.cpus.empty()) {
+    CpuTopology::bindCurrentThread(options_.cpus);
+  }
+  TaskQueue::setThreadWaitGroup(worker.node);
+  // 工作线程向全局队列提交（包括本地队列溢出）时不受容量限制
+  TaskQueue::setThreadWorkerQueue(&task_queue_);
+
+  // 应用服务质量等级（默认等级继承创建者的调度设置，不做修改）
+  {
+    std::lock_guard<std::mutex> lock(qos_mutex_);
+    worker.threadId = ThreadQoS::currentThreadId();
+    if (qos_class_ != kThreadQoSClassNormal) {
+      ThreadQoS::apply(worker.threadId, qos_class_);
+    }
+  }
 
-  // 工作循环
+  // 工作循环：本地队列 -> 本节点子队列 -> 窃取 -> 其他节点子队列 -> 全局队列
   while (running_) {
-    // 等待并执行下一个任务
-    // 使用较长的等待时间，避免频繁轮询
-    auto maxWaitTime = std::chrono::steady_clock::now() + std::chrono::seconds(1);
-    task_queue_.runNextTask(maxWaitTime);
+    // 定期检查全局队列（不等待），避免本地任务持续产生时全局任务饥饿；同时评估是否需要扩容
+    // 全局队列中有高优先级或按截止时间排序的就绪任务时每轮都检查（无锁读取计数）
+    if (++worker.tick % kGlobalQueueInterval == 0) {
+      maybeGrow();
+      if (task_queue_.runNextTask()) {
+        continue;
+      }
+    } else if (task_queue_.pendingTaskCount(kThreadQoSClassHigh) != 0 && task_queue_.runNextTask()) {
+      continue;
+    }
+
+    if (runLocalTask(worker) || runNodeTask(worker.node) || stealTask(threadIndex) ||
+        runRemoteNodeTask(worker.node) || stealNextTask(threadIndex)) {
+      continue;
+    }
+
+    // 先登记为空闲线程，再检查所有本地队列：
+    // 提交者压入本地队列后检查空闲线程数，两侧的全屏障保证至少有一方看到对方
+    parked_workers_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (hasLocalTasks()) {
+      parked_workers_.fetch_sub(1);
+      continue;
+    }
+
+    // 出现空闲线程说明没有积压
+    if (saturated_since_.load(std::memory_order_relaxed) != 0) {
+      saturated_since_.store(0, std::memory_order_relaxed);
+    }
+
+    // 等待并执行全局队列中的下一个任务
+    // 空闲时阻塞，不做周期性轮询：新任务、窃取请求（interruptWait）和 stop() 中的 dispose 都会显式唤醒；
+    // 线程数多于 minThreads 时最多等待 idleTimeout，超时后尝试退出
+    bool elastic = thread_count_.load(std::memory_order_relaxed) > options_.minThreads;
+    auto parkedAt = std::chrono::steady_clock::now();
+    auto deadline = elastic ? parkedAt + options_.idleTimeout : TaskQueue::kForever;
+    bool ranTask = task_queue_.runNextTask(deadline);
+    parked_workers_.fetch_sub(1);
+
+    // 响应窃取唤醒请求：清除标志后重新扫描本地队列，之后的提交可以再次唤醒其他线程
+    if (wake_pending_.load(std::memory_order_relaxed)) {
+      wake_pending_.store(false);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    if (ranTask) {
+      // 提交时本线程可能还在等待而没有扩容，执行完被唤醒的任务后由本线程重新评估积压
+      maybeGrow();
+    } else if (elastic && running_ && std::chrono::steady_clock::now() >= deadline && tryRetire(worker)) {
+      break;
+    }
+  }
+
+  // 槽位已在 tryRetire 中释放（本地队列已为空），线程对象由下一个使用该槽位的线程或 stop() 回收；
+  // 同一槽位的下一个线程在本线程被 join 之后才会启动，这里清除的一定是本线程的 ID
+  {
+    std::lock_guard<std::mutex> lock(qos_mutex_);
+    worker.threadId = 0;
   }
 
   // 清理线程局部变量
   current_ = nullptr;
+  TaskQueue::setThreadWorkerQueue(nullptr);
+}
+
+bool ThreadPoolDispatchQueue::pushLocal(TaskFunction& function) {
+  // 只有本线程池的工作线程使用本地队列；
+  // sync() 等待期间提交的任务进入全局队列，排在屏障之后
+  if (current_ != this || barrier_count_.load(std::memory_order_relaxed) != 0) {
+    return false;
+  }
+
+  auto& worker = *local_workers_[current_index_];
+  auto* task = ::new (ClosureAllocator::allocate(sizeof(LocalTask))) LocalTask{std::move(function)};
+  local_pending_.fetch_add(1);
+
+  // 新任务放入 next 槽位，当前任务结束后由本线程接着执行（续延式的任务链不经过任何共享队列）；
+  // 槽位原有的任务挤入本地队列
+  task = worker.next.exchange(task);
+  if (task != nullptr && !worker.deque.push(task)) {
+    // 本地队列已满：将较早的一半任务连同新任务一次性移入全局队列，之后的提交又可以使用本地队列
+    spillLocalTasks(worker.deque, task);
+    return true;
+  }
+
+  notifyLocalWork(worker.node);
+  return true;
+}
+
+bool ThreadPoolDispatchQueue::pushNodeQueue(TaskFunction* functions, size_t count) {
+  if (node_queues_.empty() || count == 0 || current_ == this || barrier_count_.load(std::memory_order_relaxed) != 0) {
+    return false;
+  }
+  // 有界线程池的外部提交都进入全局队列，由它计算容量
+  if (task_queue_.capacity() != 0) {
+    return false;
+  }
+
+  auto node = std::min(topology_.nodeOf(CpuTopology::currentCpu()), node_queues_.size() - 1);
+  auto& queue = *node_queues_[node];
+  local_pending_.fetch_add(count);
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for (size_t i = 0; i < count; ++i) {
+      queue.tasks.push_back(::new (ClosureAllocator::allocate(sizeof(LocalTask))) LocalTask{std::move(functions[i])});
+    }
+    queue.size.fetch_add(count);
+  }
+
+  notifyLocalWork(node);
+  return true;
+}
+
+bool ThreadPoolDispatchQueue::runNodeTask(size_t node) {
+  if (node >= node_queues_.size()) {
+    return false;
+  }
+  auto& queue = *node_queues_[node];
+  if (queue.size.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+
+  LocalTask* task = nullptr;
+  bool more = false;
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      return false;
+    }
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    more = !queue.tasks.empty();
+    queue.size.fetch_sub(1);
+  }
+
+  // 子队列中还有任务时，继续唤醒该节点的下一个空闲线程
+  if (more) {
+    notifyLocalWork(node);
+  }
+  runLocal(task);
+  return true;
 }
 
-void ThreadPoolDispatchQueue::sync(const DispatchFunction& function) {
+bool ThreadPoolDispatchQueue::runRemoteNodeTask(size_t node) {
+  for (size_t i = 1; i < node_queues_.size(); ++i) {
+    if (runNodeTask((node + i) % node_queues_.size())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPoolDispatchQueue::spillLocalTasks(WorkStealingDeque<LocalTask>& deque, LocalTask* task) {
+  std::vector<TaskFunction> functions;
+  functions.reserve(kLocalQueueCapacity / 2 + 1);
+
+  auto take = [&functions](LocalTask* local) {
+    functions.push_back(std::move(local->function));
+    local->~LocalTask();
+    ClosureAllocator::deallocate(local, sizeof(LocalTask));
+  };
+
+  // 拥有者从头部取出最早的任务（与窃取者竞争，取到多少算多少）
+  for (size_t i = 0; i < kLocalQueueCapacity / 2; ++i) {
+    auto* local = deque.steal();
+    if (local == nullptr) {
+      break;
+    }
+    take(local);
+  }
+  take(task);
+
+  // 先进入全局队列再减少本地计数，sync() 不会在任务转移途中执行
+  auto count = functions.size();
+  task_queue_.enqueueBatch(std::move(functions));
+  local_pending_.fetch_sub(count);
+}
+
+bool ThreadPoolDispatchQueue::runLocalTask(Worker& worker) {
+  LocalTask* task = nullptr;
+  if (worker.nextRuns < kMaxConsecutiveNextRuns) {
+    task = worker.next.exchange(nullptr);
+  }
+  if (task != nullptr) {
+    worker.nextRuns++;
+  } else {
+    worker.nextRuns = 0;
+    task = worker.deque.pop();
+    if (task == nullptr) {
+      task = worker.next.exchange(nullptr);
+    }
+    if (task == nullptr) {
+      return false;
+    }
+  }
+  runLocal(task);
+  return true;
+}
+
+bool ThreadPoolDispatchQueue::stealTask(size_t threadIndex) {
+  // 从相邻的线程开始依次尝试，分散窃取者之间的竞争；
+  // 线程分布在多个 NUMA 节点上时，第一轮只窃取同一节点的线程，第二轮再窃取其他节点
+  auto limit = slot_limit_.load(std::memory_order_relaxed);
+  auto node = local_workers_[threadIndex]->node;
+  for (size_t pass = 0; pass < (node_count_ > 1 ? 2 : 1); ++pass) {
+    for (size_t i = 1; i < limit; ++i) {
+      auto& victim = *local_workers_[(threadIndex + i) % limit];
+      if (node_count_ > 1 && (victim.node == node) != (pass == 0)) {
+        continue;
+      }
+      auto* task = victim.deque.steal();
+      if (task == nullptr) {
+        continue;
+      }
+
+      // 被窃取的队列中还有任务时，继续唤醒下一个空闲线程
+      if (!victim.deque.empty()) {
+        notifyLocalWork(victim.node);
+      }
+      runLocal(task);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPoolDispatchQueue::stealNextTask(size_t threadIndex) {
+  auto limit = slot_limit_.load(std::memory_order_relaxed);
+  for (size_t i = 1; i < limit; ++i) {
+    auto& victim = *local_workers_[(threadIndex + i) % limit];
+    if (victim.next.load(std::memory_order_relaxed) == nullptr) {
+      continue;
+    }
+
+    // 拥有者很可能即将执行该任务，稍后仍在槽位中再取走
+    std::this_thread::yield();
+    auto* task = victim.next.exchange(nullptr);
+    if (task != nullptr) {
+      runLocal(task);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPoolDispatchQueue::runLocal(LocalTask* task) {
+  task->function();
+
+  // 在减少计数之前销毁任务，确保 sync() 返回时任务持有的资源已被释放
+  task->~LocalTask();
+  ClosureAllocator::deallocate(task, sizeof(LocalTask));
+
+  if (local_pending_.fetch_sub(1) == 1 && barrier_count_.load() != 0) {
+    std::lock_guard<std::mutex> lock(local_mutex_);
+    local_drained_.notify_all();
+  }
+}
+
+void ThreadPoolDispatchQueue::notifyLocalWork(size_t node) {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (parked_workers_.load(std::memory_order_relaxed) == 0) {
+    maybeGrow();
+    return;
+  }
+
+  // 同一时刻只保留一个唤醒请求，被唤醒的线程窃取成功后再唤醒下一个
+  if (wake_pending_.load(std::memory_order_relaxed) || wake_pending_.exchange(true)) {
+    return;
+  }
+  task_queue_.interruptWait(node);
+}
+
+bool ThreadPoolDispatchQueue::hasLocalTasks() const {
+  auto limit = slot_limit_.load();
+  for (size_t i = 0; i < limit; ++i) {
+    if (!local_workers_[i]->deque.empty() || local_workers_[i]->next.load() != nullptr) {
+      return true;
+    }
+  }
+  for (const auto& queue : node_queues_) {
+    if (queue->size.load() != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t ThreadPoolDispatchQueue::localBacklog() const {
+  size_t backlog = 0;
+  auto limit = slot_limit_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < limit; ++i) {
+    backlog += local_workers_[i]->deque.size() + (local_workers_[i]->next.load(std::memory_order_relaxed) != nullptr);
+  }
+  for (const auto& queue : node_queues_) {
+    backlog += queue->size.load(std::memory_order_relaxed);
+  }
+  return backlog;
+}
+
+void ThreadPoolDispatchQueue::waitForLocalTasks() {
+  std::unique_lock<std::mutex> lock(local_mutex_);
+  local_drained_.wait(lock, [this]() { return local_pending_.load() == 0; });
+}
+
+void ThreadPoolDispatchQueue::releaseLocalTasks() {
+  for (auto& worker : local_workers_) {
+    if (auto* task = worker->next.exchange(nullptr)) {
+      task->~LocalTask();
+      ClosureAllocator::deallocate(task, sizeof(LocalTask));
+      local_pending_.fetch_sub(1);
+    }
+    while (auto* task = worker->deque.pop()) {
+      task->~LocalTask();
+      ClosureAllocator::deallocate(task, sizeof(LocalTask));
+      local_pending_.fetch_sub(1);
+    }
+  }
+  for (auto& queue : node_queues_) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    for (auto* task : queue->tasks) {
+      task->~LocalTask();
+      ClosureAllocator::deallocate(task, sizeof(LocalTask));
+      local_pending_.fetch_sub(1);
+    }
+    queue->tasks.clear();
+    queue->size.store(0);
+  }
+
+  // 唤醒可能在等待本地任务的 sync()
+  std::lock_guard<std::mutex> lock(local_mutex_);
+  local_drained_.notify_all();
+}
+
+void ThreadPoolDispatchQueue::sync(const TaskFunction& function) {
   // 如果已经在当前队列的线程上，直接执行避免死锁
   if (isCurrent()) {
     function();
     return;
   }
 
-  // 使用 barrier 实现同步执行
-  task_queue_.barrier(function);
+  // 使用 barrier 实现同步执行：
+  // 屏障到达队首时全局任务均已完成，再等待本地队列中的任务（包括由它们产生的任务）完成
+  barrier_count_.fetch_add(1);
+  task_queue_.barrier([this, &function]() {
+    waitForLocalTasks();
+    function();
+  });
+  barrier_count_.fetch_sub(1);
 }
 
-void ThreadPoolDispatchQueue::async(DispatchFunction function) { task_queue_.enqueue(std::move(function)); }
+void ThreadPoolDispatchQueue::async(TaskFunction function) {
+  if (pushLocal(function) || pushNodeQueue(&function, 1)) {
+    return;
+  }
+  task_queue_.enqueue(std::move(function));
+  maybeGrow();
+}
 
-TaskId ThreadPoolDispatchQueue::asyncAfter(DispatchFunction function, std::chrono::steady_clock::duration delay) {
+TaskId ThreadPoolDispatchQueue::asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay) {
   return task_queue_.enqueue(std::move(function), delay).id;
 }
 
-void ThreadPoolDispatchQueue::cancel(TaskId taskId) { task_queue_.cancel(taskId); }
+void ThreadPoolDispatchQueue::async(TaskFunction function, ThreadQoSClass priority) {
+  if (priority == kThreadQoSClassNormal) {
+    async(std::move(function));
+    return;
+  }
+  // 本地队列和子队列没有优先级，总是先于全局队列执行，因此其他优先级都进入全局队列
+  task_queue_.enqueue(std::move(function), priority);
+  maybeGrow();
+}
 
-bool ThreadPoolDispatchQueue::isCurrent() const { return current_ == this; }
+TaskId ThreadPoolDispatchQueue::asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay,
+                                           ThreadQoSClass priority) {
+  return task_queue_.enqueue(std::move(function), std::chrono::steady_clock::now() + delay, priority).id;
+}
 
-void ThreadPoolDispatchQueue::fullTeardown() {
-  // 标记停止
-  running_ = false;
+void ThreadPoolDispatchQueue::asyncWithDeadline(TaskFunction function, std::chrono::steady_clock::duration deadline) {
+  // 与非默认优先级的任务一样进入全局队列，由 TaskQueue 按截止时间排序
+  task_queue_.enqueueWithDeadline(std::move(function), std::chrono::steady_clock::now() + deadline);
+  maybeGrow();
+}
 
-  // 销毁任务队列，唤醒所有等待的线程
-  task_queue_.dispose();
+bool ThreadPoolDispatchQueue::tryAsync(TaskFunction&& function) {
+  if (pushLocal(function) || pushNodeQueue(&function, 1)) {
+    return true;
+  }
+  if (task_queue_.tryEnqueue(std::move(function)).id == 0) {
+    return false;
+  }
+  maybeGrow();
+  return true;
+}
 
-  // 等待所有工作线程结束
-  for (auto& worker : workers_) {
-    if (worker && worker->joinable()) {
-      worker->join();
-    }
+bool ThreadPoolDispatchQueue::tryAsync(TaskFunction&& function, TaskFunction onSpaceAvailable) {
+  if (pushLocal(function) || pushNodeQueue(&function, 1)) {
+    return true;
+  }
+  if (task_queue_.tryEnqueue(std::move(function), std::move(onSpaceAvailable)).id == 0) {
+    return false;
+  }
+  maybeGrow();
+  return true;
+}
+
+void ThreadPoolDispatchQueue::asyncBatch(std::vector<TaskFunction> functions) {
+  // 工作线程内提交时尽量压入本地队列，剩余的任务一次性进入全局队列
+  size_t pushed = 0;
+  while (pushed < functions.size() && pushLocal(functions[pushed])) {
+    pushed++;
+  }
+  if (pushed == functions.size() || pushNodeQueue(functions.data() + pushed, functions.size() - pushed)) {
+    return;
+  }
+  functions.erase(functions.begin(), functions.begin() + static_cast<std::ptrdiff_t>(pushed));
+  task_queue_.enqueueBatch(std::move(functions));
+  maybeGrow();
+}
+
+TaskId ThreadPoolDispatchQueue::asyncBatchAfter(std::vector<TaskFunction> functions,
+                                                std::chrono::steady_clock::duration delay) {
+  return task_queue_.enqueueBatch(std::move(functions), delay).id;
+}
+
+void ThreadPoolDispatchQueue::runParallelFor(size_t count, size_t grain, void* body, ParallelForChunk run) {
+  // 工作线程中调用时，调用线程本身就是一个工作线程
+  auto threads = threadCount();
+  auto participants = isCurrent() ? std::max<size_t>(threads, 1) : threads + 1;
+
+  // 默认的最小块大小：每个线程最多约 64 个尾部小块，兼顾负载均衡和游标竞争
+  if (grain == 0) {
+    grain = std::max<size_t>(1, count / (participants * 64));
+  }
+
+  // 迭代数不足以分给多个线程时直接在调用线程执行
+  auto helpers = std::min(participants - 1, (count - 1) / grain);
+  if (helpers == 0) {
+    run(body, 0, count);
+    return;
+  }
+
+  auto state = std::make_shared<ParallelForState>(count, grain, helpers + 1, body, run);
+  std::vector<TaskFunction> tasks;
+  tasks.reserve(helpers);
+  for (size_t i = 0; i < helpers; ++i) {
+    tasks.emplace_back([state]() { state->work(); });
+  }
+  asyncBatch(std::move(tasks));
+
+  // 调用线程参与执行，之后只需等待其他线程正在执行的块
+  state->work();
+  if (state->completed.load(std::memory_order_acquire) != count) {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state, count]() { return state->completed.load(std::memory_order_acquire) == count; });
   }
-  workers_.clear();
 }
 
+void ThreadPoolDispatchQueue::cancel(TaskId taskId) { task_queue_.cancel(taskId); }
+
+bool ThreadPoolDispatchQueue::isCurrent() const { return current_ == this; }
+
+void ThreadPoolDispatchQueue::fullTeardown() { stop(); }
+
 void ThreadPoolDispatchQueue::setListener(const std::shared_ptr<IQueueListener>& listener) {
   task_queue_.setListener(listener);
 }
 
 std::shared_ptr<IQueueListener> ThreadPoolDispatchQueue::getListener() const { return task_queue_.getListener(); }
 
+void ThreadPoolDispatchQueue::setSchedulingPolicy(SchedulingPolicy policy) { task_queue_.setSchedulingPolicy(policy); }
+
+void ThreadPoolDispatchQueue::setDeadlineMissPolicy(DeadlineMissPolicy policy) {
+  task_queue_.setDeadlineMissPolicy(policy);
+}
+
+DeadlineStats ThreadPoolDispatchQueue::deadlineStats() const { return task_queue_.deadlineStats(); }
+
+void ThreadPoolDispatchQueue::setCapacity(size_t capacity, OverflowPolicy policy) {
+  task_queue_.setCapacity(capacity, policy);
+}
+
+OverflowStats ThreadPoolDispatchQueue::overflowStats() const { return task_queue_.overflowStats(); }
+
+void ThreadPoolDispatchQueue::setQoSClass(ThreadQoSClass qosClass) {
+  std::lock_guard<std::mutex> lock(qos_mutex_);
+  qos_class_ = qosClass;
+  for (auto& worker : local_workers_) {
+    if (worker->threadId != 0) {
+      ThreadQoS::apply(worker->threadId, qosClass);
+    }
+  }
+}
+
 }  // namespace dispatch
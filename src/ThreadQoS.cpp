@@ -0,0 +1,110 @@
+/**
+ * @file ThreadQoS.cpp
+ * @brief 线程服务质量等级与操作系统调度策略实现
+ */
+
+#include "dispatcher/ThreadQoS.h"
+
+#include <atomic>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dispatch {
+
+namespace {
+
+// 进程级配置，分别读写（只在 setConfig 时修改）
+std::atomic<int> g_realtimePolicy{static_cast<int>(RealtimePolicy::None)};
+std::atomic<int> g_realtimePriority{1};
+
+}  // namespace
+
+ThreadQoS::NativeId ThreadQoS::currentThreadId() {
+#ifdef __linux__
+  return static_cast<NativeId>(syscall(SYS_gettid));
+#else
+  return 0;
+#endif
+}
+
+int ThreadQoS::niceValue(ThreadQoSClass qosClass) {
+  switch (qosClass) {
+    case kThreadQoSClassLowest:
+      return 19;
+    case kThreadQoSClassLow:
+      return 10;
+    case kThreadQoSClassHigh:
+      return -5;
+    case kThreadQoSClassMax:
+      return -10;
+    case kThreadQoSClassNormal:
+    default:
+      return 0;
+  }
+}
+
+bool ThreadQoS::apply(NativeId thread, ThreadQoSClass qosClass) {
+#ifdef __linux__
+  if (thread == 0) {
+    return false;
+  }
+  auto tid = static_cast<pid_t>(thread);
+
+  int policy = SCHED_OTHER;
+  sched_param param{};
+  switch (qosClass) {
+    case kThreadQoSClassLowest:
+      policy = SCHED_IDLE;
+      break;
+    case kThreadQoSClassLow:
+      policy = SCHED_BATCH;
+      break;
+    case kThreadQoSClassMax: {
+      auto realtime = static_cast<RealtimePolicy>(g_realtimePolicy.load(std::memory_order_relaxed));
+      if (realtime != RealtimePolicy::None) {
+        policy = realtime == RealtimePolicy::Fifo ? SCHED_FIFO : SCHED_RR;
+        auto priority = g_realtimePriority.load(std::memory_order_relaxed);
+        auto minimum = sched_get_priority_min(policy);
+        auto maximum = sched_get_priority_max(policy);
+        param.sched_priority = priority < minimum ? minimum : (priority > maximum ? maximum : priority);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+
+  // 在 Linux 上 sched_setscheduler/setpriority 作用于给定 ID 的单个线程
+  if (sched_setscheduler(tid, policy, &param) != 0) {
+    return false;
+  }
+  // 实时调度不使用 nice 值
+  if (policy == SCHED_FIFO || policy == SCHED_RR) {
+    return true;
+  }
+  return setpriority(PRIO_PROCESS, static_cast<id_t>(tid), niceValue(qosClass)) == 0;
+#else
+  (void)thread;
+  (void)qosClass;
+  return false;
+#endif
+}
+
+void ThreadQoS::setConfig(const ThreadQoSConfig& config) {
+  g_realtimePolicy.store(static_cast<int>(config.realtimePolicy), std::memory_order_relaxed);
+  g_realtimePriority.store(config.realtimePriority, std::memory_order_relaxed);
+}
+
+ThreadQoSConfig ThreadQoS::config() {
+  ThreadQoSConfig config;
+  config.realtimePolicy = static_cast<RealtimePolicy>(g_realtimePolicy.load(std::memory_order_relaxed));
+  config.realtimePriority = g_realtimePriority.load(std::memory_order_relaxed);
+  return config;
+}
+
+}  // namespace dispatch
@@ -5,16 +5,24 @@
 
 #include "dispatcher/ThreadedDispatchQueue.h"
 
+#include <algorithm>
 #include <cassert>
 #include <condition_variable>
 #include <future>
 #include <mutex>
 
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
 namespace dispatch {
 
 // 线程本地存储：当前线程所属的调度队列
 static thread_local ThreadedDispatchQueue* current_ = nullptr;
 
+// 工作线程每次加锁最多取出的任务数
+static constexpr size_t kMaxBatchSize = 32;
+
 ThreadedDispatchQueue::ThreadedDispatchQueue(const std::string& name, ThreadQoSClass qosClass)
     : taskQueue_(std::make_shared<TaskQueue>()),
       name_(name),
@@ -23,7 +31,7 @@ ThreadedDispatchQueue::ThreadedDispatchQueue(const std::string& name, ThreadQoSC
 
 ThreadedDispatchQueue::~ThreadedDispatchQueue() { teardown(); }
 
-void ThreadedDispatchQueue::sync(const DispatchFunction& function) {
+void ThreadedDispatchQueue::sync(const TaskFunction& function) {
   if (disableSyncCallsInCallingThread_) {
     // 禁用调用线程执行：使用 promise/future 实现同步
     std::promise<void> promise;
@@ -52,7 +60,7 @@ void ThreadedDispatchQueue::sync(const DispatchFunction& function) {
   });
 }
 
-void ThreadedDispatchQueue::async(DispatchFunction function) {
+void ThreadedDispatchQueue::async(TaskFunction function) {
   auto task = taskQueue_->enqueue(std::move(function));
 
   // 如果是第一个任务，启动工作线程
@@ -61,7 +69,7 @@ void ThreadedDispatchQueue::async(DispatchFunction function) {
   }
 }
 
-TaskId ThreadedDispatchQueue::asyncAfter(DispatchFunction function, std::chrono::steady_clock::duration delay) {
+TaskId ThreadedDispatchQueue::asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay) {
   auto task = taskQueue_->enqueue(std::move(function), delay);
 
   // 如果是第一个任务，启动工作线程
@@ -72,6 +80,79 @@ TaskId ThreadedDispatchQueue::asyncAfter(DispatchFunction function, std::chrono:
   return task.id;
 }
 
+void ThreadedDispatchQueue::async(TaskFunction function, ThreadQoSClass priority) {
+  auto task = taskQueue_->enqueue(std::move(function), priority);
+
+  // 如果是第一个任务，启动工作线程
+  if (task.isFirst) {
+    startThread();
+  }
+}
+
+TaskId ThreadedDispatchQueue::asyncAfter(TaskFunction function, std::chrono::steady_clock::duration delay,
+                                         ThreadQoSClass priority) {
+  auto task = taskQueue_->enqueue(std::move(function), std::chrono::steady_clock::now() + delay, priority);
+
+  // 如果是第一个任务，启动工作线程
+  if (task.isFirst) {
+    startThread();
+  }
+
+  return task.id;
+}
+
+void ThreadedDispatchQueue::asyncWithDeadline(TaskFunction function, std::chrono::steady_clock::duration deadline) {
+  auto task = taskQueue_->enqueueWithDeadline(std::move(function), std::chrono::steady_clock::now() + deadline);
+
+  // 如果是第一个任务，启动工作线程
+  if (task.isFirst) {
+    startThread();
+  }
+}
+
+bool ThreadedDispatchQueue::tryAsync(TaskFunction&& function) {
+  auto task = taskQueue_->tryEnqueue(std::move(function));
+
+  // 如果是第一个任务，启动工作线程
+  if (task.isFirst) {
+    startThread();
+  }
+
+  return task.id != 0;
+}
+
+bool ThreadedDispatchQueue::tryAsync(TaskFunction&& function, TaskFunction onSpaceAvailable) {
+  auto task = taskQueue_->tryEnqueue(std::move(function), std::move(onSpaceAvailable));
+
+  // 如果是第一个任务，启动工作线程
+  if (task.isFirst) {
+    startThread();
+  }
+
+  return task.id != 0;
+}
+
+void ThreadedDispatchQueue::asyncBatch(std::vector<TaskFunction> functions) {
+  auto task = taskQueue_->enqueueBatch(std::move(functions));
+
+  // 如果是第一个任务，启动工作线程
+  if (task.isFirst) {
+    startThread();
+  }
+}
+
+TaskId ThreadedDispatchQueue::asyncBatchAfter(std::vector<TaskFunction> functions,
+                                              std::chrono::steady_clock::duration delay) {
+  auto task = taskQueue_->enqueueBatch(std::move(functions), delay);
+
+  // 如果是第一个任务，启动工作线程
+  if (task.isFirst) {
+    startThread();
+  }
+
+  return task.id;
+}
+
 void ThreadedDispatchQueue::cancel(TaskId taskId) { taskQueue_->cancel(taskId); }
 
 std::shared_ptr<IQueueListener> ThreadedDispatchQueue::getListener() const { return taskQueue_->getListener(); }
@@ -80,21 +161,57 @@ bool ThreadedDispatchQueue::isCurrent() const { return this == getCurrent(); }
 
 bool ThreadedDispatchQueue::isDisposed() const { return taskQueue_->isDisposed(); }
 
+AllocatorStats ThreadedDispatchQueue::allocatorStats() const { return taskQueue_->allocatorStats(); }
+
 bool ThreadedDispatchQueue::hasThreadRunning() const {
+  // 因空闲超时退出的线程对象保留到下一次启动或销毁时回收，还需按启动与退出次数判断
   std::lock_guard<std::mutex> lock(mutex_);
-  return thread_ != nullptr;
+  return thread_ != nullptr &&
+         threadStarts_.load(std::memory_order_acquire) > threadRetirements_.load(std::memory_order_acquire);
+}
+
+void ThreadedDispatchQueue::setIdleTimeout(std::chrono::steady_clock::duration idleTimeout) {
+  idleTimeout_.store(std::max(idleTimeout, std::chrono::steady_clock::duration::zero()).count());
+  // 让正在无限期等待的工作线程按新的超时重新等待
+  taskQueue_->interruptWait();
+}
+
+ThreadStats ThreadedDispatchQueue::threadStats() const {
+  ThreadStats stats;
+  stats.threadRetirements = threadRetirements_.load(std::memory_order_acquire);
+  stats.threadStarts = threadStarts_.load(std::memory_order_acquire);
+  stats.threadRunning = hasThreadRunning();
+  stats.stackBytes = stats.threadRunning ? stackBytes_.load(std::memory_order_relaxed) : 0;
+  stats.nodeBytesRetained = taskQueue_->allocatorStats().bytesRetained;
+  return stats;
 }
 
+void ThreadedDispatchQueue::setSchedulingPolicy(SchedulingPolicy policy) { taskQueue_->setSchedulingPolicy(policy); }
+
+void ThreadedDispatchQueue::setDeadlineMissPolicy(DeadlineMissPolicy policy) {
+  taskQueue_->setDeadlineMissPolicy(policy);
+}
+
+DeadlineStats ThreadedDispatchQueue::deadlineStats() const { return taskQueue_->deadlineStats(); }
+
+void ThreadedDispatchQueue::setCapacity(size_t capacity, OverflowPolicy policy) {
+  taskQueue_->setCapacity(capacity, policy);
+}
+
+OverflowStats ThreadedDispatchQueue::overflowStats() const { return taskQueue_->overflowStats(); }
+
 void ThreadedDispatchQueue::setListener(const std::shared_ptr<IQueueListener>& listener) {
   taskQueue_->setListener(listener);
 }
 
 void ThreadedDispatchQueue::setQoSClass(ThreadQoSClass qosClass) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  // 使用单独的锁：mutex_ 在 join 工作线程期间被持有，而工作线程启动时需要读取等级
+  std::lock_guard<std::mutex> lock(qosMutex_);
   qosClass_ = qosClass;
-  // 注意：std::thread 不支持运行时更改线程优先级
-  // 如需此功能，需要使用平台特定的 API
-  // 例如 Linux 的 pthread_setschedparam 或 Windows 的 SetThreadPriority
+  // 工作线程正在运行时立即应用；否则在下次启动时应用
+  if (threadId_ != 0) {
+    ThreadQoS::apply(threadId_, qosClass);
+  }
 }
 
 void ThreadedDispatchQueue::setDisableSyncCallsInCallingThread(bool disableSyncCallsInCallingThread) {
@@ -108,6 +225,9 @@ void ThreadedDispatchQueue::teardown() {
   taskQueue_->dispose();
   // 等待并销毁工作线程
   teardownThread();
+
+  std::lock_guard<std::mutex> lock(qosMutex_);
+  threadId_ = 0;
 }
 
 void ThreadedDispatchQueue::fullTeardown() { teardown(); }
@@ -115,10 +235,14 @@ void ThreadedDispatchQueue::fullTeardown() { teardown(); }
 void ThreadedDispatchQueue::startThread() {
   std::lock_guard<std::mutex> lock(mutex_);
 
-  // 确保线程尚未启动
-  assert(thread_ == nullptr);
+  // 已有的线程只可能是因空闲超时退出的线程（isFirst 在它交接之后才会再次为 true），回收后再创建
+  if (thread_ != nullptr && thread_->joinable()) {
+    assert(this != ThreadedDispatchQueue::getCurrent());
+    thread_->join();
+  }
 
   // 创建工作线程
+  threadStarts_.fetch_add(1, std::memory_order_release);
   thread_ = std::make_unique<std::thread>(
       [self = this, taskQueue = taskQueue_]() { ThreadedDispatchQueue::handler(self, taskQueue); });
 }
@@ -144,14 +268,58 @@ void ThreadedDispatchQueue::teardownThread() {
 }
 
 void ThreadedDispatchQueue::handler(ThreadedDispatchQueue* dispatchQueue, const std::shared_ptr<TaskQueue>& taskQueue) {
-  // 设置线程本地存储，标记当前线程属于此队列
+  // 设置线程本地存储，标记当前线程属于此队列（向本队列提交时不受容量限制）
   current_ = dispatchQueue;
+  TaskQueue::setThreadWorkerQueue(taskQueue.get());
+
+#ifdef __linux__
+  pthread_attr_t attr;
+  if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+    size_t stackSize = 0;
+    if (pthread_attr_getstacksize(&attr, &stackSize) == 0) {
+      dispatchQueue->stackBytes_.store(stackSize, std::memory_order_relaxed);
+    }
+    pthread_attr_destroy(&attr);
+  }
+#endif
+
+  // 新线程继承创建者的调度设置，默认等级不做修改
+  {
+    std::lock_guard<std::mutex> lock(dispatchQueue->qosMutex_);
+    dispatchQueue->threadId_ = ThreadQoS::currentThreadId();
+    if (dispatchQueue->qosClass_ != kThreadQoSClassNormal) {
+      ThreadQoS::apply(dispatchQueue->threadId_, dispatchQueue->qosClass_);
+    }
+  }
 
   // 主循环：不断从队列取任务执行
+  // 每次加锁最多取出 kMaxBatchSize 个任务，在锁外连续执行
   while (!taskQueue->isDisposed()) {
-    // 等待最多 100000 秒（实际上是无限等待，直到有任务或队列销毁）
-    taskQueue->runNextTask(std::chrono::steady_clock::now() + std::chrono::seconds(100000));
+    // 没有设置空闲超时时无限等待，直到有任务或队列销毁
+    auto idleTimeout = std::chrono::steady_clock::duration(dispatchQueue->idleTimeout_.load());
+    auto deadline = idleTimeout == std::chrono::steady_clock::duration::zero()
+                        ? TaskQueue::kForever
+                        : std::chrono::steady_clock::now() + idleTimeout;
+    if (taskQueue->runNextTasks(deadline, kMaxBatchSize) != 0) {
+      continue;
+    }
+
+    // 空闲超时：队列仍为空时交接首任务标记后退出，下一个入队的任务重新启动线程
+    // 交接之后不再访问 mutex_ 和 thread_，启动新线程的提交者会 join 本线程
+    if (deadline != TaskQueue::kForever && std::chrono::steady_clock::now() >= deadline &&
+        taskQueue->retireWorkerIfIdle()) {
+      // 下一个线程在本线程被 join 之后才会启动，这里清除的一定是本线程的 ID
+      {
+        std::lock_guard<std::mutex> lock(dispatchQueue->qosMutex_);
+        dispatchQueue->threadId_ = 0;
+      }
+      dispatchQueue->threadRetirements_.fetch_add(1, std::memory_order_release);
+      break;
+    }
   }
+
+  current_ = nullptr;
+  TaskQueue::setThreadWorkerQueue(nullptr);
 }
 
 }  // namespace dispatch